@@ -0,0 +1,31 @@
+/**
+  ******************************************************************************
+  * @file    boot.h
+  * @brief   This file contains all the function prototypes for
+  *          the boot.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+
+// Most boot steps that are timed, later steps are still counted in the total
+#define BOOT_LOG_STEPS          12
+
+// Boot timing (view with LIVE WATCH or 'b' on the debug channel)
+extern volatile uint32_t boot_total_ms;                // Reset to first live reading, 0 = still booting
+extern volatile uint8_t boot_timeouts;                 // Readiness polls that ran out of time and fell back to a fixed delay
+extern volatile uint32_t boot_reset_flags;             // RCC->CSR reset flags of this boot
+extern volatile uint8_t boot_warm;                     // 1 = warm restart, LT7680 and ST7701S init were skipped
+
+// Function prototypes
+void Boot_ReadResetCause(void);
+void Boot_Begin(void);
+void Boot_Step(const char* name, uint8_t ok);
+void Boot_Done(void);
+void Boot_Dump(void);
+
+#endif // BOOT_H
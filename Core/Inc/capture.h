@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file    capture.h
+  * @brief   This file contains all the function prototypes for
+  *          the capture.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "decode.h"
+
+// Size of one complete VFD scan (47 packets of 5 bytes)
+#define CAPTURE_FRAME_SIZE      (PACKET_WIDTH * PACKET_COUNT)
+
+// Number of frames in the circular DMA ring
+#define CAPTURE_RING_FRAMES     4
+
+// Capture statistics (view with LIVE WATCH)
+extern volatile uint32_t capture_scans;                // Scan edges seen
+extern volatile uint32_t capture_frames_completed;     // Frames received in full by the DMA
+extern volatile uint32_t capture_frames_incomplete;    // Torn frames dropped because the next scan started before DMA finished
+extern volatile uint32_t capture_frames_superseded;    // Complete frames replaced by a newer one before decode picked them up
+extern volatile uint32_t capture_frames_misaligned;    // Frames with unused bits set, SPI2 bit alignment slipped
+extern volatile uint32_t capture_frames_long;          // More than one frame of data between two scan edges (missed edge)
+extern volatile uint32_t capture_overruns;             // SPI2 overruns (bytes lost)
+extern volatile uint32_t capture_resets;               // Full SPI2 resets (start-up and desync)
+extern volatile uint32_t capture_frames_damaged_render; // Short/long/misaligned frames that arrived while the TFT was being drawn
+extern volatile uint32_t capture_period_min;           // Inter-scan period in CPU cycles, average via the debug channel
+extern volatile uint32_t capture_period_max;
+extern volatile uint32_t capture_isr_cycles_last;      // Scan edge ISR time in CPU cycles (72 per us)
+extern volatile uint32_t capture_isr_cycles_min;
+extern volatile uint32_t capture_isr_cycles_max;
+extern volatile uint32_t capture_edge_late;            // Scan edges where the ISR read the DMA position after the new frame had started
+extern volatile uint32_t capture_edge_late_bytes_max;  // Worst case, in bytes already received when the ISR ran
+
+// Function prototypes
+void Capture_ScanStart(void);
+void Capture_DmaIRQHandler(void);
+const uint8_t* Capture_GetFrame(void);
+uint32_t Capture_GetFrameTime(void);
+uint32_t Capture_FramesDamaged(void);
+void Capture_DumpStats(void);
+void Capture_FormatOverlay(char* buffer, size_t size);
+
+#endif // CAPTURE_H
@@ -0,0 +1,27 @@
+/**
+  ******************************************************************************
+  * @file    debug.h
+  * @brief   This file contains all the function prototypes for
+  *          the debug.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef DEBUG_H
+#define DEBUG_H
+
+#include <stdint.h>
+
+// Debug channel on USART2: PA2 = TX, PA3 = RX, 921600 8N1. Set to 0 to remove it from the build.
+// The baud rate is high enough to also carry the frame recorder stream, see recorder.h
+#define DEBUG_CHANNEL_ENABLED   1
+#define DEBUG_BAUD              921600
+
+// Function prototypes
+void Debug_Init(void);
+void Debug_Poll(void);
+uint8_t Debug_Pending(void);
+void Debug_Write(const char* text);
+void Debug_Printf(const char* format, ...);
+
+#endif // DEBUG_H
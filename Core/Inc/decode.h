@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file    decode.h
+  * @brief   This file contains all the function prototypes for
+  *          the decode.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef DECODE_H
+#define DECODE_H
+
+#include <stdint.h>
+
+// The number of bytes in one data packet loaded into the U4 shift register
+#define PACKET_WIDTH    5
+// Number of packets in one display refresh cycle
+#define PACKET_COUNT    47
+// Total number of character cells on the display 
+#define CHAR_COUNT      PACKET_COUNT
+// Number of rows in the character matrix
+#define CHAR_HEIGHT     7
+// Number of columns in the character matrix
+#define CHAR_WIDTH      5
+// Number of characters in the first (main) line of the display
+#define LINE1_LEN       18
+// Number of characters in the second (auxiliary) line of the display
+#define LINE2_LEN       29
+
+// Function to map character bitmaps to ASCII characters
+typedef struct {
+	uint8_t bitmap[7]; // 7 bytes for 5x7 character bitmaps
+	char ascii;        // Corresponding ASCII character
+} BitmapChar;
+
+// Font table
+extern const BitmapChar bitmap_characters[];
+extern const uint16_t bitmap_characters_count;
+
+// Decoded display
+extern char G[64];								// MAIN: G1 to G18, AUX: G19 to G47, extra guard space
+extern _Bool Annunc[19];						// Annunciators re-ordered, G1 to G18 in left-to-right order
+extern _Bool AnnuncTemp[37];
+extern uint8_t chars[CHAR_COUNT][CHAR_HEIGHT];
+extern uint8_t flags[CHAR_COUNT];
+extern const uint8_t Reorder[PACKET_COUNT];
+extern char AuxDiagString[30];
+
+// Function prototypes
+char BitmapToChar(const uint8_t* bitmap, uint8_t position);
+void Packets_to_chars(const uint8_t* frame);
+void ReorderAnnunciators(void);
+void Main_Aux(void);
+
+#endif // DECODE_H
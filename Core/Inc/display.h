@@ -40,6 +40,12 @@ void DisplayMain(void);
 void DisplaySplash(void);
 void DisplayAux(void);
 void DisplayAnnunciators(void);
+void DisplayOverlay(void);
+void DisplaySpeedTest(void);
+
+// Diagnostic overlay on the splash line, toggled at run time with 'o' on the debug channel. 0 = not built.
+#define DISPLAY_OVERLAY_ENABLED	1
+extern _Bool displayOverlay;
 
 // Settings suited for 400x960 TFT LCD (320x960 physical)
 #define Xpos_MAIN				182			// These are actually the Y position on the R6243 because LCD is rotated 90deg in use. Values in pixels.
@@ -49,6 +55,7 @@ void DisplayAnnunciators(void);
 #define Xpos_ANNUNC				150
 #define Xpos_SPLASH				326			// org 330
 #define Ypos_SPLASH				160
+#define Ypos_SPEEDTEST			772			// After the 50 character splash text (12 pixels per character)
 #define Xpos_TIMINGS			138
 #define Ypos_TIMINGS			640
 
@@ -0,0 +1,41 @@
+/**
+  ******************************************************************************
+  * @file    eeprom.h
+  * @brief   This file contains all the function prototypes for
+  *          the eeprom.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <stdint.h>
+#include "stm32f1xx_hal.h"
+
+// EEProm emulation (Flash), the last two 1 KB pages. The linker script stops FLASH short of these.
+#define EEPROM_PAGE_SIZE        1024
+#define EEPROM_PAGE0_ADDRESS    0x0800F800
+#define EEPROM_PAGE1_ADDRESS    0x0800FC00  // Also where the old firmware kept its eight fixed words
+
+// Journal slots, each holds one record: header + payload
+#define EEPROM_SLOT_SIZE        64
+#define EEPROM_SLOTS            (EEPROM_PAGE_SIZE / EEPROM_SLOT_SIZE)
+#define EEPROM_HEADER_SIZE      12
+#define EEPROM_RECORD_MAX       (EEPROM_SLOT_SIZE - EEPROM_HEADER_SIZE)    // Payload bytes per record
+#define EEPROM_RECORD_MAGIC     0x5E7A
+#define EEPROM_CRC_INIT         0xFFFF      // Start value for EEPROM_Crc16()
+
+// Journal statistics (view with LIVE WATCH)
+extern volatile uint32_t eeprom_sequence;      // Sequence number of the newest record, 0 = none
+extern volatile uint32_t eeprom_appends;       // Records written since boot
+extern volatile uint32_t eeprom_erases;        // Page erases since boot
+extern volatile uint32_t eeprom_torn;          // Slots found written but not valid (power lost mid-write)
+
+// Function prototypes
+void EEPROM_Init(void);
+uint16_t EEPROM_Read(void* data, uint16_t size);
+HAL_StatusTypeDef EEPROM_Append(const void* data, uint16_t length);
+uint16_t EEPROM_Crc16(uint16_t crc, const uint8_t* data, uint16_t length);
+
+#endif // EEPROM_H
@@ -0,0 +1,31 @@
+/**
+  ******************************************************************************
+  * @file    filter.h
+  * @brief   This file contains all the function prototypes for
+  *          the filter.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+#include "capture.h"
+
+// Number of consecutive scans a changed character or annunciator must be seen before it is committed.
+// 1 = filter disabled. At ~111 Hz scan rate, 3 scans adds ~27 ms worst case, still faster than the 35 ms render tick.
+#define FILTER_STABLE_SCANS     3
+
+// Cells that change legitimately fast and bypass the filter. Bit n = G[n + 1], i.e. bit 0 = G1, bit 46 = G47.
+#define FILTER_BYPASS_CELLS     0x0000000000000000ULL
+
+// Filter statistics (view with LIVE WATCH)
+extern volatile uint32_t filter_changes_committed;     // Changes that were stable for FILTER_STABLE_SCANS and got through
+extern volatile uint32_t filter_changes_rejected;      // Glitches that did not persist and were suppressed
+
+// Function prototypes
+const uint8_t* Filter_Frame(const uint8_t* frame, uint32_t time);
+uint8_t Filter_Changed(uint32_t* first_seen);
+
+#endif // FILTER_H
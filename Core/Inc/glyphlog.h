@@ -0,0 +1,36 @@
+/**
+  ******************************************************************************
+  * @file    glyphlog.h
+  * @brief   This file contains all the function prototypes for
+  *          the glyphlog.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef GLYPHLOG_H
+#define GLYPHLOG_H
+
+#include <stdint.h>
+#include "decode.h"
+
+// Number of different unmatched bitmaps remembered
+#define GLYPH_LOG_SIZE          16
+
+typedef struct {
+    uint8_t bitmap[CHAR_HEIGHT];    // 5x7 bitmap as decoded by Packets_to_chars, same layout as bitmap_characters[]
+    uint8_t first_position;         // G index (1 to 47) where it was first seen
+    uint32_t hits;                  // Number of times BitmapToChar() missed on it
+} GlyphLogEntry;
+
+// Glyph log (view with LIVE WATCH or dump over the debug channel)
+extern GlyphLogEntry glyph_log[GLYPH_LOG_SIZE];
+extern volatile uint8_t glyph_log_count;       // Entries in use
+extern volatile uint32_t glyph_log_misses;     // Total lookups that fell into the miss path
+extern volatile uint32_t glyph_log_dropped;    // Misses on new bitmaps after the table filled up
+
+// Function prototypes
+void GlyphLog_Record(const uint8_t* bitmap, uint8_t position);
+void GlyphLog_Clear(void);
+void GlyphLog_Dump(void);
+
+#endif // GLYPHLOG_H
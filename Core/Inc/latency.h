@@ -0,0 +1,34 @@
+/**
+  ******************************************************************************
+  * @file    latency.h
+  * @brief   This file contains all the function prototypes for
+  *          the latency.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+// Log buckets: 4 per octave of microseconds, so each bucket is at most 19 % wide.
+// Buckets 0..3 are 0..3 us, the last one takes everything from ~1.8 s up.
+#define LATENCY_SUB_BITS        2
+#define LATENCY_BUCKETS         80
+
+// Histogram and summary (view with LIVE WATCH, or 'h' on the debug channel)
+extern volatile uint32_t latency_histogram[LATENCY_BUCKETS];
+extern volatile uint32_t latency_count;
+extern volatile uint32_t latency_min_us;
+extern volatile uint32_t latency_max_us;
+extern volatile uint32_t latency_p95_us;           // Updated on each record, upper edge of the bucket
+extern volatile uint32_t latency_p99_us;
+
+// Function prototypes
+void Latency_Change(uint32_t seen);
+void Latency_Rendered(void);
+void Latency_Clear(void);
+void Latency_Dump(void);
+
+#endif // LATENCY_H
@@ -6,6 +6,34 @@
   ******************************************************************************
 */
 
-// It's lonely here!
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef LCD_H
+#define LCD_H
 
+#include <stdint.h>
 
+// Init table length flag: a delay in ms follows the payload
+#define LCD_INIT_DELAY		0x80
+
+// Bit bang half clock period. 125 ns = 4 MHz SCL, the ST7701S allows 66 ns write cycles (15 MHz).
+#define LCD_HALF_CLOCK_NS	125
+
+// Transport benchmark on the debug channel ('t'), 1 = built in
+#define LCD_BENCHMARK_ENABLED	1
+#define LCD_BENCHMARK_WORDS		256
+
+extern volatile uint32_t lcd_words_per_sec;			// 9-bit words per second, BSRR transport with CS held per command
+extern volatile uint32_t lcd_words_per_sec_legacy;	// Same, HAL pin writes with per-word CS guards as it was
+
+// Function prototypes
+void LCD_SPI_Write(uint16_t data, uint8_t bits);
+void LCD_WriteCommand(uint8_t command, const uint8_t* data, uint8_t length);
+void LCDWriteRegister(uint8_t reg);
+void LCDWriteData(uint8_t data);
+void LCD_RunInitTable(const uint8_t* table, uint16_t size);
+void AdaFruit_Init(void);
+void BuyDisplay_Init(void);
+void LCD_SetPorch(uint8_t vbp, uint8_t vfp);
+void LCD_Benchmark(void);
+
+#endif // LCD_H
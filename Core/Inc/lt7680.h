@@ -19,13 +19,16 @@ void Ohms12x24SymbolStoreUCG(void);
 //void DrawText(const char* text);
 
 // Hardware control
-void HardwareReset(void);
+uint8_t HardwareReset(void);
+uint8_t WaitStatus(uint8_t mask, uint8_t value, uint32_t timeoutMs, uint32_t fallbackMs);
+uint8_t WaitRegister(uint8_t reg, uint8_t mask, uint8_t value, uint32_t timeoutMs, uint32_t fallbackMs);
 
 // Core commands
 void WriteRegister(uint8_t reg);
 void WriteData(uint8_t data);
 uint8_t ReadStatus(void);
 uint8_t ReadData(void);
+uint8_t ReadRegister(uint8_t reg);
 void WriteDataToRegister(uint8_t reg, uint8_t value);
 
 // Testing routines
@@ -49,7 +52,12 @@ void WriteDataToRegister(uint8_t reg, uint8_t value);
 void SoftwareReset(void);
 void SetBacklightFull(void);
 void FillScreen(uint32_t color);
+uint8_t FillRectangle(uint16_t startX, uint16_t startY, uint16_t endX, uint16_t endY, uint16_t colorRED, uint16_t colorGREEN, uint16_t colorBLUE);
+uint8_t ClearScreenFast(void);
 void SendAllToLT7680_LT(void);
+uint8_t LT7680_ConfigMatches(void);
+uint8_t LT7680_Retune(void);
+void LT7680_SetPLL(const uint8_t regs[6]);
 //void SetBackgroundColor(color);
 void Text_Mode(void);
 void SetTextColors(uint32_t foreground, uint32_t background);
@@ -59,10 +67,10 @@ void SetTextColors(uint32_t foreground, uint32_t background);
 //void ConfigureFontAndPosition(uint8_t fontSource, uint8_t characterHeight, uint8_t isoCoding, uint8_t fullAlignment, uint8_t chromaKeying, uint8_t rotation, uint8_t widthFactor, uint8_t heightFactor, uint8_t lineGap, uint8_t charSpacing, uint16_t cursorX, uint16_t cursorY)
 
 // Register Configuration
-void LT7680_PLL_Initial_LT(void);
+uint8_t LT7680_PLL_Initial_LT(void);
 void Configure_Main_PIP_Window_LT(void);
-void SDRAM_Init_LT(void);
-void Check_SDRAM_Ready_LT(void);
+uint8_t SDRAM_Init_LT(void);
+uint8_t Check_SDRAM_Ready_LT(void);
 void Set_LCD_Panel_LT(void);
 void LCD_HorizontalWidth_VerticalHeight_LT(uint16_t WX, uint16_t HY);
 void LCD_Horizontal_Non_Display_LT(uint16_t val);
@@ -122,6 +130,9 @@ extern uint32_t LCD_HFPD;
 extern uint32_t LCD_HSPW;
 extern uint32_t REFRESH_RATE;
 
+extern volatile uint32_t lt7680_retune_writes;     // Registers written by the last LT7680_Retune() (view with LIVE WATCH)
+extern volatile uint32_t lt7680_bus_bytes;         // SPI1 bytes moved to/from the LT7680, free running (view with LIVE WATCH)
+
 // These have been moved to main.c as part of the user selectable timings
 //#define LCD_VBPD				17			// Vertical Back Porch				17	17	17
 //#define LCD_VFPD				14			// Vertical Front Porch				15	14	14		Adafruit tft timings say 15 but per forum user changed to 14 to stop flickering
@@ -153,6 +164,17 @@ extern uint32_t REFRESH_RATE;
 #define HOST_BUS				0			// 0 = 8bit, 1 = 16bit
 #define OUTPUT_SEQ				0b000		// 0b000 = RGB, 0b001 = RBG, 0b010 = GRB, 0b011 = GBR, 0b100 = BRG, 0b101 = BGR, 0b110 = Grey, 0b111 = Idle State			100
 #define REG_CONTROL				0x00		// Control register address
+#define STSR_WFIFO_FULL			0x80		// Status register: host memory write FIFO full
+#define STSR_WFIFO_EMPTY		0x40		// Status register: host memory write FIFO empty
+#define STSR_CORE_BUSY			0x08		// Status register: drawing engines busy
+#define STSR_SDRAM_READY		0x04		// Status register: SDRAM ready for access
+#define STSR_INHIBIT			0x02		// Status register: inhibit operation, still resetting/initialising
+#define STSR_IDLE_MASK			(STSR_WFIFO_FULL | STSR_WFIFO_EMPTY | STSR_INHIBIT)	// Out of reset: FIFO empty, not inhibited. Also rejects a floating MISO (0x00/0xFF)
+#define STSR_IDLE				STSR_WFIFO_EMPTY
+#define LT7680_RESET_TIMEOUT_MS	200			// Boot readiness polls - each falls back to the old fixed delay if it runs out
+#define LT7680_PLL_TIMEOUT_MS	20
+#define LT7680_SDRAM_TIMEOUT_MS	50
+#define LT7680_FILL_TIMEOUT_MS	100
 #define REG_TEXT_CURSOR_X       0x20		// X-coordinate of text cursor
 #define REG_TEXT_CURSOR_Y       0x21		// Y-coordinate of text cursor
 #define MAIN_IMAGE_START		0x000000	// Main image start address set to 0 (MISA)			0x20004000
@@ -19,17 +19,14 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f1xx_hal.h"
 #include <stdint.h>
+#include "decode.h"
 
 void Delay_NonBlocking(uint32_t delayMs);
 
-HAL_StatusTypeDef EEPROM_WriteData(uint32_t address, uint32_t data);				// Prototype for uint32_t write
-uint32_t EEPROM_ReadData(uint32_t address);											// Prototype for uint32_t read
-HAL_StatusTypeDef EEPROM_Write4CharString(uint32_t address, const char* str);		// Prototype for CHAR write
-void EEPROM_Read4CharString(uint32_t address, char* buffer);						// Prototype for CHAR read
-HAL_StatusTypeDef EEPROM_ErasePage(uint32_t address);								// Prototype for Erase
 
 /* Exported functions prototypes ---------------------------------------------*/
 void Error_Handler(void);
+void Main_DecodeFrame(void);
 
 /* Private defines -----------------------------------------------------------*/
 #define TEST_OUT_Pin GPIO_PIN_13				// PC13 - LED
@@ -59,20 +56,7 @@ void Error_Handler(void);
 #define VFD_SDA_GPIO_Port GPIOB
 // Note: PB10 lt7680 reset pin is in lt7680.h
 
-// The number of bytes in one data packet loaded into the U4 shift register
-#define PACKET_WIDTH    5
-// Number of packets in one display refresh cycle
-#define PACKET_COUNT    47
-// Total number of character cells on the display 
-#define CHAR_COUNT      PACKET_COUNT
-// Number of rows in the character matrix
-#define CHAR_HEIGHT     7
-// Number of columns in the character matrix
-#define CHAR_WIDTH      5
-// Number of characters in the first (main) line of the display
-#define LINE1_LEN       18
-// Number of characters in the second (auxiliary) line of the display
-#define LINE2_LEN       29
+// Packet and character cell sizes are in decode.h
 // Vertical offset of the first line (in pixels)
 #define LINE1_Y         10
 // Second line vertical offset (in pixels)
@@ -92,6 +76,43 @@ void DelayMicroseconds(uint16_t us);
 #define LCD_SCK_Port  GPIOB
 #define LCD_SDI_Port  GPIOB
 
+
+//**************************************************************************************************
+// Interrupt priority plan
+//
+// NVIC_PRIORITYGROUP_4 (set by HAL_Init): 16 pre-emption levels, no sub-priority, 0 = most urgent.
+// Every HAL_NVIC_SetPriority/NVIC_SetPriority call uses one of these, never a literal.
+//
+//   0  Scan edge (EXTI15_10, PB11)   latches the capture ring position, its latency decides where a frame starts
+//   1  Capture DMA/SPI2 (DMA1 Ch4)  transfer errors only, marks capture desync
+//   2  SysTick                       HAL tick, kept above the long handlers so HAL_GetTick timeouts stay true
+//   3  Render tick (TIM2)            sets timer_flag every 35 ms
+//   4  Render DMA (DMA1 Ch3, SPI1)   TFT transfers to the LT7680
+//   5  USART DMA (DMA1 Ch7)          debug recorder stream
+//  15  PendSV                        background work, pre-empted by everything
+//
+// Nothing above the scan edge may run for long: the capture DMA keeps receiving during any ISR,
+// but the scan edge ISR must read the DMA position before the next frame's bytes arrive.
+#define IRQ_PRIO_SCAN_EDGE      0
+#define IRQ_PRIO_CAPTURE_DMA    1
+#define IRQ_PRIO_SYSTICK        2
+#define IRQ_PRIO_RENDER_TICK    3
+#define IRQ_PRIO_RENDER_DMA     4
+#define IRQ_PRIO_USART_DMA      5
+#define IRQ_PRIO_BACKGROUND     15
+
+_Static_assert(IRQ_PRIO_SCAN_EDGE < IRQ_PRIO_CAPTURE_DMA, "Scan edge must pre-empt every other interrupt");
+_Static_assert(IRQ_PRIO_CAPTURE_DMA < IRQ_PRIO_SYSTICK && IRQ_PRIO_CAPTURE_DMA < IRQ_PRIO_RENDER_TICK
+    && IRQ_PRIO_CAPTURE_DMA < IRQ_PRIO_RENDER_DMA && IRQ_PRIO_CAPTURE_DMA < IRQ_PRIO_USART_DMA,
+    "Capture must pre-empt render and debug interrupts");
+_Static_assert(IRQ_PRIO_SYSTICK < IRQ_PRIO_RENDER_DMA && IRQ_PRIO_SYSTICK < IRQ_PRIO_USART_DMA,
+    "SysTick must pre-empt the DMA completion handlers");
+_Static_assert(IRQ_PRIO_RENDER_TICK < IRQ_PRIO_RENDER_DMA, "Render tick must pre-empt render DMA");
+_Static_assert(IRQ_PRIO_RENDER_DMA < IRQ_PRIO_USART_DMA, "Render DMA must pre-empt the debug recorder");
+_Static_assert(IRQ_PRIO_USART_DMA < IRQ_PRIO_BACKGROUND, "Background must be the lowest priority");
+_Static_assert(IRQ_PRIO_BACKGROUND < (1 << __NVIC_PRIO_BITS), "Priority out of range for the STM32F1 NVIC");
+_Static_assert(TICK_INT_PRIORITY == IRQ_PRIO_SYSTICK, "TICK_INT_PRIORITY in stm32f1xx_hal_conf.h must match IRQ_PRIO_SYSTICK");
+
 	
 	
 	
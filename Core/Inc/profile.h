@@ -0,0 +1,63 @@
+/**
+  ******************************************************************************
+  * @file    profile.h
+  * @brief   This file contains all the function prototypes for
+  *          the profile.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+// Per-stage DWT profiling, 1 = built in, 0 = the markers compile to nothing (the host build in Host/ sets 0)
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED     1
+#endif
+
+// Stages timed, one RAM table entry each. Every stage is only ever timed from one context.
+typedef enum {
+    PROFILE_CAPTURE_ISR = 0,    // Scan edge ISR (EXTI)
+    PROFILE_PACKETS,            // Packets_to_chars, PendSV
+    PROFILE_MAIN_AUX,           // Main_Aux, PendSV, includes the BitmapToChar calls
+    PROFILE_BITMAP,             // BitmapToChar, one character
+    PROFILE_DISPLAY_MAIN,       // DisplayMain, main loop
+    PROFILE_DISPLAY_AUX,        // DisplayAux
+    PROFILE_DISPLAY_ANNUNC,     // DisplayAnnunciators
+    PROFILE_DISPLAY_SPLASH,     // DisplaySplash
+    PROFILE_STAGES
+} ProfileStage;
+
+#if PROFILE_ENABLED
+
+#include "timer.h"
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;               // CPU cycles, 72 per us
+    uint32_t max;
+    uint64_t total;             // For the average
+} ProfileStats;
+
+// Per-stage figures (view with LIVE WATCH, or 'p' on the debug channel)
+extern volatile ProfileStats profile_stats[PROFILE_STAGES];
+
+// Scoped markers, BEGIN and END of a stage must be in the same block
+#define PROFILE_BEGIN(stage)    uint32_t profile_start_##stage = DWT_GetCycles()
+#define PROFILE_END(stage)      Profile_Record(stage, DWT_GetCycles() - profile_start_##stage)
+
+// Function prototypes
+void Profile_Record(ProfileStage stage, uint32_t cycles);
+void Profile_Clear(void);
+void Profile_Dump(void);
+
+#else
+
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+
+#endif // PROFILE_ENABLED
+
+#endif // PROFILE_H
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file    recorder.h
+  * @brief   This file contains all the function prototypes for
+  *          the recorder.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdint.h>
+
+// Recording format
+// ----------------
+// The stream is a sequence of records, all multi-byte values little endian:
+//
+//   offset  size  field
+//   0       1     sync, RECORDER_SYNC
+//   1       1     type, RECORDER_START / RECORDER_KEYFRAME / RECORDER_DELTA / RECORDER_STOP
+//   2       2     payload length
+//   4       4     timestamp, CPU cycles (Timer_Stamp()) at the scan edge that started the frame (wraps every 2^32 cycles)
+//   8       2     frame sequence number, counts every complete frame, gaps = frames not recorded
+//   10      n     payload
+//   10+n    1     checksum, XOR of all preceding bytes of the record
+//
+// Payloads:
+//   START     version (1), frame size (1), cycle counter clock in Hz (4)
+//   KEYFRAME  the complete 235 byte frame
+//   DELTA     runs of bytes changed since the previous frame: position (1), count (1), bytes (count).
+//             An empty payload means the frame did not change.
+//   STOP      none
+//
+// A keyframe is sent every RECORDER_KEYFRAME_INTERVAL frames and after any frame that could not be
+// queued, so a reader can start anywhere: skip to a sync byte whose record checksum is valid, then
+// wait for a keyframe. See Host/rec_convert.c.
+
+#define RECORDER_SYNC               0xA5
+#define RECORDER_START              'S'
+#define RECORDER_KEYFRAME           'K'
+#define RECORDER_DELTA              'D'
+#define RECORDER_STOP               'X'
+#define RECORDER_VERSION            1
+#define RECORDER_HEADER_SIZE        10
+
+#define RECORDER_KEYFRAME_INTERVAL  111     // ~1 s at the R6243 scan rate
+#define RECORDER_RING_SIZE          2048    // USART2 TX DMA ring buffer
+
+// Recorder statistics (view with LIVE WATCH)
+extern volatile uint32_t recorder_frames_recorded;
+extern volatile uint32_t recorder_frames_dropped;     // Frames that did not fit in the ring buffer
+
+// Function prototypes
+void Recorder_Start(void);
+void Recorder_Stop(void);
+uint8_t Recorder_Active(void);
+void Recorder_Frame(const uint8_t* frame, uint32_t timestamp);
+
+#endif // RECORDER_H
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file    settings.h
+  * @brief   This file contains all the function prototypes for
+  *          the settings.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+#include "stm32f1xx_hal.h"
+
+#define SETTINGS_MAGIC          0x5354      // "ST"
+#define SETTINGS_VERSION        1           // Bump only when the meaning of an existing field changes
+
+// Defaults, used when nothing valid is stored
+#define SETTINGS_DEFAULT_VBPD   17
+#define SETTINGS_DEFAULT_VFPD   14
+#define SETTINGS_DEFAULT_VSPW   2
+#define SETTINGS_DEFAULT_HBPD   50
+#define SETTINGS_DEFAULT_HFPD   30
+#define SETTINGS_DEFAULT_HSPW   10
+#define SETTINGS_DEFAULT_REFRESH 60
+#define SETTINGS_DEFAULT_PANEL  "AdaF"
+
+// The stored settings record. New settings are added at the end: a shorter record written by older
+// firmware loads with the new fields at their defaults, so no new offsets or layout versions are needed.
+typedef struct __attribute__((packed)) {
+    uint16_t magic;             // SETTINGS_MAGIC
+    uint8_t version;            // SETTINGS_VERSION
+    uint8_t size;               // Bytes in this record as written, header included
+    uint16_t crc;               // CRC-16/CCITT over everything after this field, up to size
+
+    uint16_t vbpd;              // TFT timings, see LCD_VBPD etc.
+    uint16_t vfpd;
+    uint16_t vspw;
+    uint16_t hbpd;
+    uint16_t hfpd;
+    uint16_t hspw;
+    uint16_t refresh_rate;
+    char panel[5];              // ST7701S init table, "AdaF" or "BuyD", null terminated
+} Settings;
+
+#define SETTINGS_HEADER_SIZE    6
+
+typedef enum {
+    SETTINGS_LOADED = 0,        // Valid record from the journal
+    SETTINGS_LEGACY,            // Valid values from the old fixed-offset layout, not yet in the journal
+    SETTINGS_DEFAULTS           // Nothing valid stored, defaults loaded
+} SettingsSource;
+
+// Function prototypes
+void Settings_Defaults(Settings* settings);
+SettingsSource Settings_Load(Settings* settings);
+HAL_StatusTypeDef Settings_Save(Settings* settings);
+
+#endif // SETTINGS_H
@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file    speedtest.h
+  * @brief   This file contains all the function prototypes for
+  *          the speedtest.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SPEEDTEST_H
+#define SPEEDTEST_H
+
+#include <stdint.h>
+
+// Window the DWT cycle counter is compared against SysTick over
+#define SPEEDTEST_WINDOW_MS     200
+
+// Iterations of the old boot test loop that are timed, ~13 ms on a good board
+#define SPEEDTEST_LOOPS         20000
+
+// Verdict limits. The old 1 s boot test counted 1497606 loops/s on a good board.
+#define SPEEDTEST_MIN_LOOPS     750000      // Loops/s below this = slow/clone part
+#define SPEEDTEST_CLOCK_TOL_PM  20          // Measured core clock within +/- 2.0 % of SystemCoreClock
+
+typedef enum {
+    SPEEDTEST_IDLE = 0,
+    SPEEDTEST_RUNNING,
+    SPEEDTEST_DONE
+} SpeedTestState;
+
+// Results (view with LIVE WATCH)
+extern volatile uint32_t dbg_loop_per_sec;             // Old boot test loop rate, same units as before
+extern volatile uint32_t speedtest_core_hz;            // Core clock measured by the DWT against SysTick, 0 = DWT not counting
+extern volatile uint8_t speedtest_ok;                  // 1 = genuine-looking part
+
+// Function prototypes
+void SpeedTest_Start(void);
+void SpeedTest_Poll(void);
+SpeedTestState SpeedTest_State(void);
+void SpeedTest_Format(char* buffer, uint8_t size);
+
+#endif // SPEEDTEST_H
@@ -129,7 +129,7 @@
   * @brief This is the HAL system configuration section
   */
 #define  VDD_VALUE                    3300U /*!< Value of VDD in mv */
-#define  TICK_INT_PRIORITY            15U    /*!< tick interrupt priority (lowest by default)  */
+#define  TICK_INT_PRIORITY            2U     /*!< tick interrupt priority, see IRQ_PRIO_SYSTICK in main.h */
 #define  USE_RTOS                     0U
 #define  PREFETCH_ENABLE              1U
 
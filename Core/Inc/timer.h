@@ -14,11 +14,21 @@
 // Externally accessible variables
 extern volatile uint8_t timer_flag;
 extern volatile uint8_t task_ready;
+extern volatile uint16_t cpu_idle_permille;    // CPU idle time over the last second, 0.1 % units (view with LIVE WATCH)
 
 // Function prototypes
 void TIM2_Init(void);
 void TIM2_IRQHandler(void);
 void SetTimerDuration(uint16_t ms);
+void DWT_Init(void);
+void CPU_Idle(uint8_t sleep);
+uint32_t Timer_Stamp(void);
+
+// DWT cycle counter, 72 MHz, wraps every 59.6 s. Use unsigned subtraction for intervals.
+// May stop while the core sleeps, use Timer_Stamp() for intervals that can span a WFI.
+static inline uint32_t DWT_GetCycles(void) {
+    return DWT->CYCCNT;
+}
 
 #endif // TIMER_H
 
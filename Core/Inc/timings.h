@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file    timings.h
+  * @brief   This file contains all the function prototypes for
+  *          the timings.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TIMINGS_H
+#define TIMINGS_H
+
+#include <stdint.h>
+#include <string.h>
+
+// PC build (Host/timing_gen.c): no HAL, the panel size and clock limits below are all it needs
+#ifndef TIMINGS_HOST
+#include "lt7680.h"
+#endif
+
+// Panel size and LT7680 clock limits the PLL registers are worked out for, timings.c checks them
+// against lt7680.h
+#define TIMINGS_XSIZE           400
+#define TIMINGS_YSIZE           960
+#define TIMINGS_SCLK_MAX        65
+#define TIMINGS_MCLK_MAX        100
+#define TIMINGS_CCLK_MAX        100
+
+// User profile area, one Flash page below the EEProm journal. Profiles are programmed there as
+// TimingProfile records, back to back from the start of the page, the first record without the
+// magic ends the list. Left erased = built-in profiles only. Host/timing_gen writes the page image.
+#define TIMINGS_USER_ADDRESS    0x0800F400
+#define TIMINGS_USER_SIZE       1024
+#define TIMINGS_MAGIC           0x5054      // "TP"
+
+// One timing set as shown on the timing adjust screen, with the LT7680 PLL registers worked out for it
+typedef struct __attribute__((packed)) {
+    uint16_t magic;             // TIMINGS_MAGIC
+    uint8_t vbpd;               // Vertical back porch, front porch, sync pulse width (lines)
+    uint8_t vfpd;
+    uint8_t vspw;
+    uint16_t hbpd;              // Horizontal back porch, front porch, sync pulse width (pixels)
+    uint16_t hfpd;
+    uint16_t hspw;
+    uint8_t refresh_rate;       // Hz
+    char panel[5];              // ST7701S init table, "AdaF" or "BuyD", null terminated
+    uint8_t pll[6];             // LT7680 REG05..REG0A (PCLK, MCLK, CCLK), all 0xFF = work out at run time
+    uint8_t reserved;           // Keeps records a whole number of half-words
+} TimingProfile;
+
+// LT7680 PLL registers for a timing set, worked out by the compiler the same way PLL_Registers_LT() does:
+// clock in MHz rounded, SCLK = pixel clock, MCLK = CCLK = twice that, each limited, OD = 2 and R = 5.
+#define TIMINGS_MHZ(vbpd, vfpd, vspw, hbpd, hfpd, hspw, rate) \
+    ((((hbpd) + (hfpd) + (hspw) + TIMINGS_XSIZE) * ((vbpd) + (vfpd) + (vspw) + TIMINGS_YSIZE) * (rate) + 500000UL) / 1000000UL)
+#define TIMINGS_LIMIT(mhz, max) ((mhz) > (max) ? (max) : (mhz))
+#define TIMINGS_PLL_REGS(n)     (uint8_t)((2 << 6) | (5 << 1) | (((n) >> 8) & 0x1)), (uint8_t)((n) & 0xFF)
+#define TIMINGS_PLL(mhz)        { TIMINGS_PLL_REGS(TIMINGS_LIMIT(mhz, TIMINGS_SCLK_MAX)), \
+                                  TIMINGS_PLL_REGS(TIMINGS_LIMIT((mhz) * 2, TIMINGS_MCLK_MAX)), \
+                                  TIMINGS_PLL_REGS(TIMINGS_LIMIT((mhz) * 2, TIMINGS_CCLK_MAX)) }
+
+#define TIMING_PROFILE(vbpd, vfpd, vspw, hbpd, hfpd, hspw, rate, panel) \
+    { TIMINGS_MAGIC, vbpd, vfpd, vspw, hbpd, hfpd, hspw, rate, panel, \
+      TIMINGS_PLL(TIMINGS_MHZ(vbpd, vfpd, vspw, hbpd, hfpd, hspw, rate)), 0xFF }
+
+// Same limits as the stored settings, a bad user record must not take the panel down
+static inline uint8_t Timings_Valid(const TimingProfile* p) {
+    return p->magic == TIMINGS_MAGIC
+        && p->vbpd >= 5 && p->vbpd <= 50
+        && p->vfpd >= 1 && p->vspw >= 1
+        && p->hbpd >= 8 && p->hbpd <= 2048 && p->hfpd <= 2048 && p->hspw <= 256
+        && p->refresh_rate >= 30 && p->refresh_rate <= 120
+        && memchr(p->panel, '\0', sizeof(p->panel)) != NULL;
+}
+
+// Function prototypes
+void Timings_Init(void);
+uint8_t Timings_Count(void);
+const TimingProfile* Timings_Get(uint8_t index);
+const TimingProfile* Timings_Find(void);
+const uint8_t* Timings_PLL(const TimingProfile* profile);
+
+#endif // TIMINGS_H
@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file    trace.h
+  * @brief   This file contains all the function prototypes for
+  *          the trace.c file
+  ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// ITM/SWO event trace, 1 = built in, 0 = Trace_Event() compiles to nothing
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED           1
+#endif
+
+// Trace format
+// ------------
+// Each event is one 32-bit write to an ITM stimulus port, the port number is the event type, so every
+// event is a 5 byte SWIT packet on the wire (header + 4 payload bytes, little endian):
+//
+//   bits 31..20  argument, see the event list, limited to TRACE_ARG_MAX
+//   bits 19..0   time, CPU cycles (Timer_Stamp()) / 64 (0.89 us at 72 MHz), wraps every 2^26 cycles (0.93 s)
+//
+// Events come at least every scan (~9 ms), so a reader unwraps the time by adding 2^20 whenever it
+// goes backwards. A render pass can outlast the 12-bit argument in us, so its time is taken from the
+// RENDER_START/RENDER_END timestamps instead. See Host/swo_decode.c.
+//
+//   port  event         argument
+//   1     FRAME         frame length in bytes, scan edge ISR closed a complete frame
+//   2     DECODE        decode time in us (filter + Packets_to_chars + Main_Aux)
+//   3     RENDER_START  0
+//   4     RENDER_END    0
+//   5     BUS           LT7680 SPI bytes moved during the render pass / 16
+//   6     TIMEOUT       LT7680 register polled (0x100 = status register)
+
+#define TRACE_FRAME             1
+#define TRACE_DECODE            2
+#define TRACE_RENDER_START      3
+#define TRACE_RENDER_END        4
+#define TRACE_BUS               5
+#define TRACE_TIMEOUT           6
+#define TRACE_EVENTS            7
+
+#define TRACE_TIME_BITS         20
+#define TRACE_TIME_SHIFT        6
+#define TRACE_ARG_MAX           0xFFF
+#define TRACE_BUS_SHIFT         4
+
+// SWO bit rate, NRZ (UART). The SWO pin (PB3) is shared with LCD_CS.
+#define TRACE_SWO_BAUD          2000000
+
+#if TRACE_ENABLED
+
+// Trace statistics (view with LIVE WATCH)
+extern volatile uint32_t trace_events;          // Events written
+extern volatile uint32_t trace_dropped;         // Events dropped because the ITM FIFO was full
+
+// Function prototypes
+void Trace_Start(void);
+uint8_t Trace_ReleasePin(void);
+void Trace_RestorePin(uint8_t claimed);
+void Trace_Event(uint8_t event, uint32_t arg);
+
+#else
+
+#define Trace_Start()
+#define Trace_ReleasePin()          0
+#define Trace_RestorePin(claimed)   ((void)(claimed))
+#define Trace_Event(event, arg)
+
+#endif // TRACE_ENABLED
+
+#endif // TRACE_H
@@ -0,0 +1,100 @@
+/**
+  ******************************************************************************
+  * @file    boot.c
+  * @brief   This file provides code for the per-step
+  *          timing log of the boot sequence
+  ******************************************************************************
+*/
+
+// Each boot step calls Boot_Step() when it finishes, the time since the previous step is taken
+// from the DWT cycle counter. Steps that poll the LT7680 pass ok = 0 when the poll timed out
+// and a fixed delay was used instead, so a slow or marginal board shows up in the log.
+// The time before Boot_Begin() (clock and HAL start-up) is taken from the HAL tick.
+//
+// After a reset that did not come from power-on, the LT7680 and ST7701S have usually kept their
+// set-up. main() then probes the LT7680 (LT7680_ConfigMatches) and skips the display bring-up.
+
+#include "boot.h"
+#include "timer.h"
+#include "debug.h"
+#include "speedtest.h"
+#include "eeprom.h"
+#include "stm32f1xx_hal.h"
+
+typedef struct {
+    const char* name;
+    uint32_t cycles;
+    uint8_t ok;
+} BootStep;
+
+static BootStep boot_steps[BOOT_LOG_STEPS];
+static uint8_t boot_step_count = 0;
+static uint32_t boot_start_ms = 0;
+static uint32_t boot_last = 0;
+
+volatile uint32_t boot_total_ms = 0;
+volatile uint8_t boot_timeouts = 0;
+volatile uint32_t boot_reset_flags = 0;
+volatile uint8_t boot_warm = 0;
+
+
+// Latch and clear the RCC reset flags, call first thing in main()
+void Boot_ReadResetCause(void) {
+    boot_reset_flags = RCC->CSR;
+    RCC->CSR |= RCC_CSR_RMVF;
+}
+
+
+// Start timing, call as soon as the DWT is running
+void Boot_Begin(void) {
+    boot_start_ms = HAL_GetTick();
+    boot_last = DWT_GetCycles();
+    boot_step_count = 0;
+    boot_timeouts = 0;
+}
+
+
+// Record the end of a boot step
+void Boot_Step(const char* name, uint8_t ok) {
+    uint32_t now = DWT_GetCycles();
+
+    if (!ok) {
+        boot_timeouts++;
+    }
+    if (boot_step_count < BOOT_LOG_STEPS) {
+        boot_steps[boot_step_count].name = name;
+        boot_steps[boot_step_count].cycles = now - boot_last;
+        boot_steps[boot_step_count].ok = ok;
+        boot_step_count++;
+    }
+    boot_last = now;
+}
+
+
+// Boot finished, the main loop is about to show live readings
+void Boot_Done(void) {
+    boot_total_ms = HAL_GetTick();
+}
+
+
+// Print the boot timing over the debug channel
+void Boot_Dump(void) {
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
+
+    Debug_Printf("Boot: %lu ms to live, %lu ms before timing started, %u timeouts\n",
+        (unsigned long)boot_total_ms, (unsigned long)boot_start_ms, boot_timeouts);
+    Debug_Printf("Reset: %s%s%s%s%s, %s start\n",
+        (boot_reset_flags & RCC_CSR_PORRSTF) ? "POR " : "", (boot_reset_flags & RCC_CSR_PINRSTF) ? "PIN " : "",
+        (boot_reset_flags & RCC_CSR_SFTRSTF) ? "SW " : "", (boot_reset_flags & RCC_CSR_IWDGRSTF) ? "IWDG " : "",
+        (boot_reset_flags & RCC_CSR_WWDGRSTF) ? "WWDG " : "", boot_warm ? "warm" : "cold");
+    for (uint8_t i = 0; i < boot_step_count; i++) {
+        Debug_Printf("  %-16s %7lu us%s\n", boot_steps[i].name,
+            (unsigned long)(boot_steps[i].cycles / cycles_per_us), boot_steps[i].ok ? "" : "  TIMEOUT");
+    }
+    if (SpeedTest_State() == SPEEDTEST_DONE) {
+        Debug_Printf("BluePill: %lu loops/s, core %lu kHz, %s\n", (unsigned long)dbg_loop_per_sec,
+            (unsigned long)(speedtest_core_hz / 1000), speedtest_ok ? "OK" : "SLOW/CLONE");
+    }
+    Debug_Printf("Settings: record %lu, %lu written, %lu erases, %lu torn slots\n", (unsigned long)eeprom_sequence,
+        (unsigned long)eeprom_appends, (unsigned long)eeprom_erases, (unsigned long)eeprom_torn);
+}
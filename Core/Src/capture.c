@@ -0,0 +1,372 @@
+/**
+  ******************************************************************************
+  * @file    capture.c
+  * @brief   This file provides code for the capture
+  *          of VFD frames from the R6243 via SPI2 + DMA
+  ******************************************************************************
+*/
+
+// SPI2 RX runs continuously into a ring of CAPTURE_RING_FRAMES frames with DMA1 Ch4 in
+// circular mode, the DMA is never stopped during normal capture. The scan edge ISR only
+// latches the DMA write position as the start of the new frame:
+//
+//   ring:  ... | frame n-1 | frame n        | frame n+1 (being received) ...
+//                          ^ previous edge  ^ latest edge     ^ DMA write position
+//
+// Capture_GetFrame() slices the newest complete frame out of the ring and copies it into the
+// decode buffer: the frame after the latest edge once all 235 bytes have arrived, otherwise the
+// frame closed by that edge. In the circular ring there is no per-frame DMA interrupt, so the
+// scan edge ISR is where a frame is known to be finished; it pends PendSV, which decodes it at
+// the lowest priority straight away. Frames that were never collected before a newer one was
+// closed are counted as superseded.
+//
+// The scan edge ISR is the highest priority interrupt (see the plan in main.h), but it can still
+// be held off by a critical section. Any bytes of the new frame that arrive before it reads the
+// DMA position show up as a previous frame longer than 235 bytes; up to CAPTURE_LATE_BYTES_MAX of
+// them are handed back to the new frame and counted as edge latency.
+//
+// A scan that is shorter than 235 bytes when the next edge arrives is counted as incomplete
+// and never sliced. The full HAL/RCC reset of SPI2 is only done at start-up and after a
+// desync: SPI2 overrun, DMA transfer error, more than one frame between two edges, or a
+// frame with any of the unused packet bits set. After a reset the ring starts again at 0.
+
+#include "capture.h"
+#include "spi.h"
+#include "recorder.h"
+#include "timer.h"
+#include "debug.h"
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CAPTURE_RING_SIZE   (CAPTURE_RING_FRAMES * CAPTURE_FRAME_SIZE)
+
+// Most bytes the scan edge ISR may be late by before the frame is treated as a missed edge
+#define CAPTURE_LATE_BYTES_MAX  (2 * PACKET_WIDTH)
+
+extern volatile uint8_t Init_Completed_flag;
+extern DMA_HandleTypeDef hdma_spi2_rx;
+
+// Capture ring, written by DMA only
+static uint8_t capture_ring[CAPTURE_RING_SIZE];
+
+// Frame being decoded, owned by the main loop
+static uint8_t capture_frame[CAPTURE_FRAME_SIZE];
+
+// Frame handed to the recorder from the scan edge ISR
+static uint8_t capture_record_frame[CAPTURE_FRAME_SIZE];
+
+static volatile uint16_t capture_boundary = 0;         // Ring position of the latest scan edge
+static volatile uint32_t capture_boundary_time = 0;    // Timer_Stamp() of the latest scan edge
+static volatile uint16_t capture_closed = 0;           // Ring position of the frame closed by the latest scan edge
+static volatile uint32_t capture_closed_time = 0;      // Timer_Stamp() of its scan edge
+static volatile uint8_t capture_closed_complete = 0;   // 1 = that frame was received in full
+static volatile uint32_t capture_scan_number = 0;      // Counts scan edges since the last reset, 0 = none yet
+static uint32_t capture_frame_time = 0;                 // Timer_Stamp() of the scan edge that started capture_frame
+static volatile uint32_t capture_taken_scan = 0;       // Scan number of the last frame collected by the main loop
+static volatile uint8_t capture_desync = 0;            // 1 = SPI2 needs a full reset on the next scan edge
+static uint8_t capture_armed = 0;                      // 0 = SPI2 not yet set up
+
+// Capture statistics
+volatile uint32_t capture_scans = 0;
+volatile uint32_t capture_frames_completed = 0;
+volatile uint32_t capture_frames_incomplete = 0;
+volatile uint32_t capture_frames_superseded = 0;
+volatile uint32_t capture_frames_misaligned = 0;
+volatile uint32_t capture_frames_long = 0;
+volatile uint32_t capture_overruns = 0;
+volatile uint32_t capture_resets = 0;
+volatile uint32_t capture_period_min = 0;
+volatile uint32_t capture_period_max = 0;
+static uint64_t capture_period_sum = 0;
+static uint32_t capture_period_count = 0;
+static uint32_t capture_last_edge = 0;
+volatile uint32_t capture_frames_damaged_render = 0;
+volatile uint32_t capture_isr_cycles_last = 0;
+volatile uint32_t capture_isr_cycles_min = 0;
+volatile uint32_t capture_isr_cycles_max = 0;
+volatile uint32_t capture_edge_late = 0;
+volatile uint32_t capture_edge_late_bytes_max = 0;
+
+
+// Current DMA write position in the ring
+static inline uint16_t WritePosition(void) {
+    return (uint16_t)(CAPTURE_RING_SIZE - DMA1_Channel4->CNDTR);
+}
+
+
+// Bytes received from ring position 'from' up to 'to'
+static inline uint16_t RingDistance(uint16_t from, uint16_t to) {
+    return (uint16_t)((to + CAPTURE_RING_SIZE - from) % CAPTURE_RING_SIZE);
+}
+
+
+// Copy a frame out of the ring, it may wrap round the end
+static void SliceFrame(uint8_t* dst, uint16_t start) {
+    uint16_t first = CAPTURE_RING_SIZE - start;
+
+    if (first >= CAPTURE_FRAME_SIZE) {
+        memcpy(dst, &capture_ring[start], CAPTURE_FRAME_SIZE);
+    }
+    else {
+        memcpy(dst, &capture_ring[start], first);
+        memcpy(dst + first, capture_ring, CAPTURE_FRAME_SIZE - first);
+    }
+}
+
+
+// Full reset of SPI2 and restart of the circular DMA at the start of the ring.
+// Used at start-up and after a desync, the scan edge that called it becomes position 0.
+static void FullReset(void) {
+    DMA1_Channel4->CCR &= ~DMA_CCR_EN;
+    HAL_SPI_DMAStop(&hspi2);              // Used to ensure robustness when failures occur in SPI transfers.
+    HAL_SPI_Abort(&hspi2);                // ---- "" ----
+    __HAL_RCC_SPI2_FORCE_RESET();         // ---- "" ----
+    __HAL_RCC_SPI2_RELEASE_RESET();       // ---- "" ----
+    HAL_SPI_Init(&hspi2);                 // ---- "" ----
+
+    DMA1_Channel4->CCR = 0;
+    DMA1->IFCR = DMA_IFCR_CGIF4;
+    DMA1_Channel4->CPAR = (uint32_t)&SPI2->DR;
+    DMA1_Channel4->CMAR = (uint32_t)capture_ring;
+    DMA1_Channel4->CNDTR = CAPTURE_RING_SIZE;
+    DMA1_Channel4->CCR = (hdma_spi2_rx.Init.Priority) | DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_TEIE;   // Peripheral to memory, 8 bit, circular
+    DMA1_Channel4->CCR |= DMA_CCR_EN;
+
+    SPI2->CR2 |= SPI_CR2_RXDMAEN;
+    SPI2->CR1 |= SPI_CR1_SPE;
+
+    capture_boundary = 0;
+    capture_closed_complete = 0;
+    capture_scan_number = 0;
+    capture_taken_scan = 0;
+    capture_desync = 0;
+    capture_resets++;
+}
+
+
+// Start of a new VFD scan - called from EXTI15_10_IRQHandler
+void Capture_ScanStart(void) {
+    if (!Init_Completed_flag) {
+        return;
+    }
+
+    uint32_t start = DWT_GetCycles();
+    uint32_t now = Timer_Stamp();         // Scan edges are a sleep apart, the DWT may not have counted in between
+
+    // Inter-scan period
+    if (capture_scans != 0) {
+        uint32_t period = now - capture_last_edge;
+        if (period < capture_period_min || capture_period_min == 0) {
+            capture_period_min = period;
+        }
+        if (period > capture_period_max) {
+            capture_period_max = period;
+        }
+        capture_period_sum += period;
+        capture_period_count++;
+    }
+    capture_last_edge = now;
+    capture_scans++;
+
+    if (SPI2->SR & SPI_SR_OVR) {
+        capture_overruns++;
+        capture_desync = 1;               // Bytes were lost, the bit alignment can no longer be trusted
+    }
+
+    if (capture_desync || !capture_armed) {
+        FullReset();
+        capture_armed = 1;
+        capture_boundary_time = now;
+        capture_scan_number = 1;
+    }
+    else {
+        uint16_t position = WritePosition();
+        uint16_t length = RingDistance(capture_boundary, position);
+
+        // Close the previous frame
+        if (length >= CAPTURE_FRAME_SIZE && length <= CAPTURE_FRAME_SIZE + CAPTURE_LATE_BYTES_MAX) {
+            uint16_t late = length - CAPTURE_FRAME_SIZE;
+            if (late != 0) {
+                // ISR entered after the new frame had started, its first bytes belong to the new frame
+                capture_edge_late++;
+                if (late > capture_edge_late_bytes_max) {
+                    capture_edge_late_bytes_max = late;
+                }
+                position = (uint16_t)((capture_boundary + CAPTURE_FRAME_SIZE) % CAPTURE_RING_SIZE);
+            }
+
+            capture_frames_completed++;
+            if (Recorder_Active()) {
+                SliceFrame(capture_record_frame, capture_boundary);
+                Recorder_Frame(capture_record_frame, capture_boundary_time);
+            }
+        }
+        else if (length < CAPTURE_FRAME_SIZE) {
+            capture_frames_incomplete++;
+        }
+        else {
+            capture_frames_long++;        // Missed a scan edge
+            capture_desync = 1;
+        }
+
+        // The frame closed by the previous edge drops out of reach now
+        if (capture_closed_complete && capture_taken_scan < capture_scan_number - 1) {
+            capture_frames_superseded++;
+        }
+
+        capture_closed = capture_boundary;
+        capture_closed_time = capture_boundary_time;
+        capture_closed_complete = !capture_desync && length >= CAPTURE_FRAME_SIZE;
+        if (capture_closed_complete) {
+            SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;     // Deferred decode, see Main_DecodeFrame()
+            Trace_Event(TRACE_FRAME, length);
+        }
+
+        capture_boundary = position;
+        capture_boundary_time = now;
+        capture_scan_number++;
+    }
+
+    // Per-edge ISR time
+    uint32_t cycles = DWT_GetCycles() - start;
+    capture_isr_cycles_last = cycles;
+    if (cycles > capture_isr_cycles_max) {
+        capture_isr_cycles_max = cycles;
+    }
+    if (cycles < capture_isr_cycles_min || capture_isr_cycles_min == 0) {
+        capture_isr_cycles_min = cycles;
+    }
+}
+
+
+// Sanity check of a received frame. Bits 5..2 of the third byte of every packet are never driven
+// by the R6243 (see Packets_to_chars), if any is set the capture has slipped by one or more bits.
+static uint8_t FrameAligned(const uint8_t* frame) {
+    for (int i = 0; i < PACKET_COUNT; i++) {
+        if (frame[i * PACKET_WIDTH + 2] & 0x3C) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+// SPI2 RX DMA interrupt, only enabled for transfer errors - called from DMA1_Channel4_IRQHandler
+void Capture_DmaIRQHandler(void) {
+    if (DMA1->ISR & DMA_ISR_TEIF4) {
+        capture_desync = 1;
+    }
+    DMA1->IFCR = DMA_IFCR_CGIF4;
+}
+
+
+// Scan number of the newest complete frame not yet collected, 0 = none. Call with interrupts masked.
+static uint32_t NewestFrame(uint16_t* start, uint32_t* time) {
+    uint32_t scan = capture_scan_number;
+
+    if (scan == 0) {
+        return 0;
+    }
+    if (scan > capture_taken_scan && RingDistance(capture_boundary, WritePosition()) >= CAPTURE_FRAME_SIZE) {
+        *start = capture_boundary;
+        *time = capture_boundary_time;
+        return scan;
+    }
+    if (capture_closed_complete && scan - 1 > capture_taken_scan) {
+        *start = capture_closed;
+        *time = capture_closed_time;
+        return scan - 1;
+    }
+    return 0;
+}
+
+
+// Collect the latest complete frame. Returns NULL if no new frame has arrived since the last call.
+// The returned buffer is a copy and stays valid until the next call.
+const uint8_t* Capture_GetFrame(void) {
+    uint16_t boundary;
+    uint32_t time;
+
+    __disable_irq();
+    uint32_t scan = NewestFrame(&boundary, &time);
+    if (scan != 0) {
+        capture_taken_scan = scan;
+    }
+    __enable_irq();
+
+    if (scan == 0) {
+        return NULL;
+    }
+
+    // The DMA is at most two scans into the ring past this frame, still clear of it while copying
+    SliceFrame(capture_frame, boundary);
+    capture_frame_time = time;
+
+    // SPI2 gets a full reset on the next scan edge. The frame is still passed on, the consensus
+    // filter keeps a one-off bad frame off the screen, and if the check ever fires on every frame
+    // capture simply falls back to resetting on every scan.
+    if (!FrameAligned(capture_frame)) {
+        capture_frames_misaligned++;
+        capture_desync = 1;
+    }
+
+    return capture_frame;
+}
+
+
+// Arrival time (Timer_Stamp() of its scan edge) of the frame last returned by Capture_GetFrame()
+uint32_t Capture_GetFrameTime(void) {
+    return capture_frame_time;
+}
+
+
+// Average inter-scan period in cycles
+static uint32_t PeriodAverage(void) {
+    __disable_irq();
+    uint64_t sum = capture_period_sum;
+    uint32_t count = capture_period_count;
+    __enable_irq();
+
+    return count ? (uint32_t)(sum / count) : 0;
+}
+
+
+// Frames lost to capture problems. Superseded frames are not included, a newer frame replaced them.
+uint32_t Capture_FramesDamaged(void) {
+    return capture_frames_incomplete + capture_frames_long + capture_frames_misaligned;
+}
+
+
+// Print the capture statistics over the debug channel
+void Capture_DumpStats(void) {
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
+
+    Debug_Printf("Capture: %lu scans, %lu completed, %lu short, %lu superseded, %lu long\n",
+        (unsigned long)capture_scans, (unsigned long)capture_frames_completed,
+        (unsigned long)capture_frames_incomplete, (unsigned long)capture_frames_superseded,
+        (unsigned long)capture_frames_long);
+    Debug_Printf("Errors: %lu overruns, %lu misaligned, %lu resets, %lu damaged while rendering\n",
+        (unsigned long)capture_overruns, (unsigned long)capture_frames_misaligned,
+        (unsigned long)capture_resets, (unsigned long)capture_frames_damaged_render);
+    Debug_Printf("Scan period: min %lu, avg %lu, max %lu us\n",
+        (unsigned long)(capture_period_min / cycles_per_us), (unsigned long)(PeriodAverage() / cycles_per_us),
+        (unsigned long)(capture_period_max / cycles_per_us));
+    Debug_Printf("Scan edge ISR: last %lu, min %lu, max %lu cycles\n",
+        (unsigned long)capture_isr_cycles_last, (unsigned long)capture_isr_cycles_min,
+        (unsigned long)capture_isr_cycles_max);
+    Debug_Printf("Scan edge latency: %lu late edges, max %lu bytes (limit %u)\n",
+        (unsigned long)capture_edge_late, (unsigned long)capture_edge_late_bytes_max,
+        (unsigned)CAPTURE_LATE_BYTES_MAX);
+}
+
+
+// One line summary for the on-screen overlay
+void Capture_FormatOverlay(char* buffer, size_t size) {
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
+
+    snprintf(buffer, size, "Scans %lu  Lost %lu  Resets %lu  Period %lu/%lu/%lu us",
+        (unsigned long)capture_scans, (unsigned long)Capture_FramesDamaged(), (unsigned long)capture_resets,
+        (unsigned long)(capture_period_min / cycles_per_us), (unsigned long)(PeriodAverage() / cycles_per_us),
+        (unsigned long)(capture_period_max / cycles_per_us));
+}
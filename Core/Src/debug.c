@@ -0,0 +1,178 @@
+/**
+  ******************************************************************************
+  * @file    debug.c
+  * @brief   This file provides code for the serial debug
+  *          channel on USART2
+  ******************************************************************************
+*/
+
+// Simple text debug channel so field units can be interrogated without a debugger attached.
+// Connect a 3.3V USB-serial adapter to PA2 (TX) / PA3 (RX) and send a single character command:
+//
+//   ?  - list commands
+//   g  - dump the unmatched glyph log
+//   G  - clear the unmatched glyph log
+//   c  - capture statistics
+//   l  - CPU load
+//   b  - boot step timing
+//   t  - ST7701S transport benchmark
+//   o  - toggle the on-screen diagnostic overlay
+//   r  - start/stop the raw frame recorder (binary, see recorder.h)
+//
+// Output is polled and blocking, it is only ever sent in response to a command.
+// While the recorder is running it owns TX and text output is dropped.
+// The UART HAL module is not enabled, so USART2 is driven at register level like TIM2.
+
+#include "debug.h"
+#include "stm32f1xx_hal.h"
+#include "glyphlog.h"
+#include "recorder.h"
+#include "capture.h"
+#include "display.h"
+#include "timer.h"
+#include "boot.h"
+#include "lcd.h"
+#include "profile.h"
+#include "latency.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+#if DEBUG_CHANNEL_ENABLED
+
+// Initialise USART2 and its pins
+void Debug_Init(void) {
+    GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    RCC->APB1ENR |= RCC_APB1ENR_USART2EN;   // Enable USART2 clock
+
+    GPIO_InitStruct.Pin = GPIO_PIN_2;       // PA2 - TX
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+    GPIO_InitStruct.Pin = GPIO_PIN_3;       // PA3 - RX
+    GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;     // Idle high when nothing is connected
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+    USART2->CR1 = 0;
+    USART2->BRR = (HAL_RCC_GetPCLK1Freq() + DEBUG_BAUD / 2) / DEBUG_BAUD;   // 36 MHz / 921600 = 39.06
+    USART2->CR1 = USART_CR1_TE | USART_CR1_RE | USART_CR1_UE;              // 8N1, no interrupts
+}
+
+
+// Send a string, blocking
+void Debug_Write(const char* text) {
+    if (Recorder_Active()) {
+        return;
+    }
+
+    while (*text) {
+        if (*text == '\n') {
+            while (!(USART2->SR & USART_SR_TXE));
+            USART2->DR = '\r';
+        }
+        while (!(USART2->SR & USART_SR_TXE));
+        USART2->DR = (uint8_t)*text++;
+    }
+}
+
+
+// Formatted output, lines longer than the buffer are truncated
+void Debug_Printf(const char* format, ...) {
+    char buffer[96];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    Debug_Write(buffer);
+}
+
+
+// 1 = a command is waiting to be read
+uint8_t Debug_Pending(void) {
+    return (USART2->SR & USART_SR_RXNE) != 0;
+}
+
+
+// Check for a command, call from the main loop
+void Debug_Poll(void) {
+    if (!(USART2->SR & USART_SR_RXNE)) {
+        return;
+    }
+
+    char command = (char)USART2->DR;        // Reading DR also clears any overrun
+
+    switch (command) {
+    case 'g':
+        GlyphLog_Dump();
+        break;
+    case 'G':
+        GlyphLog_Clear();
+        Debug_Write("Glyph log cleared\n");
+        break;
+    case 'c':
+        Capture_DumpStats();
+        break;
+    case 'l':
+        Debug_Printf("CPU idle %u.%u %%\n", cpu_idle_permille / 10, cpu_idle_permille % 10);
+        break;
+    case 'b':
+        Boot_Dump();
+        break;
+#if LCD_BENCHMARK_ENABLED
+    case 't':
+        LCD_Benchmark();
+        Debug_Printf("ST7701S transport: %lu words/s, was %lu words/s\n",
+            (unsigned long)lcd_words_per_sec, (unsigned long)lcd_words_per_sec_legacy);
+        break;
+#endif
+#if PROFILE_ENABLED
+    case 'p':
+        Profile_Dump();
+        break;
+    case 'P':
+        Profile_Clear();
+        Debug_Write("Profile cleared\n");
+        break;
+#endif
+    case 'h':
+        Latency_Dump();
+        break;
+    case 'H':
+        Latency_Clear();
+        Debug_Write("Latency histogram cleared\n");
+        break;
+    case 'o':
+        displayOverlay = !displayOverlay;
+        break;
+    case 'r':
+        if (Recorder_Active()) {
+            Recorder_Stop();
+            Debug_Printf("Recorder stopped, %lu frames, %lu dropped\n",
+                (unsigned long)recorder_frames_recorded, (unsigned long)recorder_frames_dropped);
+        }
+        else {
+            Recorder_Start();
+        }
+        break;
+    case '?':
+        Debug_Write("c = capture stats, l = CPU load, b = boot timing, t = panel link speed, p = stage profile, P = clear profile, h = update latency, H = clear latency, o = overlay, g = glyph log, G = clear glyph log, r = start/stop recorder\n");
+        break;
+    default:
+        break;
+    }
+}
+
+#else
+
+void Debug_Init(void) {}
+void Debug_Poll(void) {}
+uint8_t Debug_Pending(void) { return 0; }
+void Debug_Write(const char* text) { (void)text; }
+void Debug_Printf(const char* format, ...) { (void)format; }
+
+#endif // DEBUG_CHANNEL_ENABLED
@@ -12,6 +12,8 @@
 #include "lcd.h"
 #include "lt7680.h"
 #include "display.h"
+#include "capture.h"
+#include "speedtest.h"
 #include <string.h>  // For strchr, strncpy
 #include <stdio.h>   // For debugging (optional)
 #include <stdbool.h>
@@ -38,8 +40,9 @@ _Bool onethousandmVmodedetected;
 char MaindisplayString[19] = "";              // String for G[1] to G[18]
 _Bool displayBlank = false;
 _Bool displayBlankPrevious = false;
-
-extern volatile uint32_t dbg_loop_per_sec;
+_Bool displayOverlay = false;
+static _Bool displayOverlayShown = false;
+static _Bool splashActive = true;
 
 // 6243 testing
 volatile int aux_dollarCount = 0;
@@ -343,6 +346,7 @@ void DisplaySplash() {
 		if (cycle_count >= (DURATION_MS / TIMER_INTERVAL_MS)) {
 			// Runs once
 			timer_active = 0; // Stop counting after 5 seconds
+			splashActive = false;
 			SetTextColors(0x00FF00, ColourBackground); // Foreground: Yellow, Background: Black
 			ConfigureFontAndPosition(
 				0b00,    // Internal CGROM
@@ -435,55 +439,90 @@ void DisplaySplash() {
 }
 
 
-// Write Cpu speed rating to the MAIN TFT.
-void DisplayCloneDeterminationMain(void)
+// BluePill speed test verdict after the splash text, shown until the splash ends. Green = OK, red = slow/clone.
+void DisplaySpeedTest(void)
 {
-	SetTextColors(MainColourFore, BackgroundColour);
+	static _Bool shown = false;
+	static _Bool cleared = false;
+	char speedStr[17];
+
+	if (cleared || SpeedTest_State() != SPEEDTEST_DONE || (shown && splashActive)) {
+		return;
+	}
+
+	if (splashActive) {
+		SpeedTest_Format(speedStr, sizeof(speedStr));
+		SetTextColors(speedtest_ok ? 0x00FF00 : 0xFF0000, ColourBackground);
+		shown = true;
+	}
+	else {
+		// Splash is over (or the result came too late for it), clear the text
+		memset(speedStr, ' ', sizeof(speedStr) - 1);
+		speedStr[sizeof(speedStr) - 1] = '\0';
+		SetTextColors(ColourBackground, ColourBackground);
+		cleared = true;
+		if (!shown) {
+			return;
+		}
+	}
+
 	ConfigureFontAndPosition(
 		0b00,    // Internal CGROM
-		0b10,    // Font size
+		0b00,    // Font size
 		0b00,    // ISO 8859-1
 		0,       // Full alignment enabled
 		0,       // Chroma keying disabled
 		1,       // Rotate 90 degrees counterclockwise
-		0b11,    // Width multiplier
-		0b11,    // Height multiplier
+		0b00,    // Width multiplier
+		0b00,    // Height multiplier
 		1,       // Line spacing
 		4,       // Character spacing
-		Xpos_MAIN,
-		Ypos_MAIN
+		Xpos_SPLASH,     // Cursor X
+		Ypos_SPEEDTEST   // Cursor Y
 	);
-	char loopStr[32];
-
-	strcpy(loopStr, "LS=");
-	sprintf(&loopStr[strlen(loopStr)], "%lu", dbg_loop_per_sec);
-
-	DrawText(loopStr);
+	DrawText(speedStr);
 }
 
 
-// Write Cpu speed rating to the AUX TFT.
-void DisplayCloneDeterminationAux(void)
+// Diagnostic overlay - capture health on the splash line once the splash has gone
+void DisplayOverlay(void)
 {
-	SetTextColors(AuxColourForeLS, BackgroundColour);
+#if DISPLAY_OVERLAY_ENABLED
+	char overlayStr[60];
+
+	if (splashActive || (!displayOverlay && !displayOverlayShown)) {
+		return;
+	}
+
+	if (displayOverlay) {
+		Capture_FormatOverlay(overlayStr, sizeof(overlayStr));
+	}
+	else {
+		overlayStr[0] = '\0';			// Clear it once after switching off
+	}
+
+	// Pad to the full width so a shorter line overwrites the previous one
+	size_t len = strlen(overlayStr);
+	memset(&overlayStr[len], ' ', sizeof(overlayStr) - 1 - len);
+	overlayStr[sizeof(overlayStr) - 1] = '\0';
+
+	SetTextColors(0x909090, ColourBackground); // Foreground: grey, Background: Black
 	ConfigureFontAndPosition(
 		0b00,    // Internal CGROM
-		0b01,    // Font size
+		0b00,    // Font size
 		0b00,    // ISO 8859-1
 		0,       // Full alignment enabled
 		0,       // Chroma keying disabled
 		1,       // Rotate 90 degrees counterclockwise
-		0b01,    // Width multiplier
-		0b01,    // Height multiplier
-		5,       // Line spacing
-		0,       // Character spacing
-		Xpos_AUX,
-		Ypos_AUX
+		0b00,    // Width multiplier
+		0b00,    // Height multiplier
+		1,       // Line spacing
+		4,       // Character spacing
+		Xpos_SPLASH,     // Cursor X
+		Ypos_SPLASH      // Cursor Y
 	);
-	char loopStr[32];
-
-	strcpy(loopStr, "BluePill speed = ");
-	sprintf(&loopStr[strlen(loopStr)], "%lu", dbg_loop_per_sec);
+	DrawText(overlayStr);
 
-	DrawText(loopStr);
+	displayOverlayShown = displayOverlay;
+#endif
 }
@@ -0,0 +1,218 @@
+/**
+  ******************************************************************************
+  * @file    eeprom.c
+  * @brief   This file provides code for the wear-levelled
+  *          settings journal in the emulated EEProm (Flash)
+  ******************************************************************************
+*/
+
+// The old code erased the settings page and programmed it word by word on every save, a 20-40 ms
+// bus stall each time and one erase cycle of the page per button press. The journal appends instead:
+//
+//   Two pages, EEPROM_SLOTS fixed slots each. A save programs the next free slot with a record:
+//
+//     +0  magic      EEPROM_RECORD_MAGIC, programmed last so a torn write never looks valid
+//     +2  length     payload bytes
+//     +4  sequence   32-bit, one up on the previous record
+//     +8  crc        CRC-16/CCITT over length, sequence and payload
+//     +10 reserved   left erased
+//     +12 payload
+//
+//   When the active page is full the other page is erased and the journal carries on there, the old
+//   page keeps the previous records until the next switch. So one erase per EEPROM_SLOTS saves, and
+//   a power cut during the erase or the write still leaves the previous record readable.
+//
+// EEPROM_Init() scans both pages once at boot (header checks, CRC only on slots that carry the magic)
+// and keeps the newest record and the next free slot. The record payload is opaque to this module.
+
+#include "eeprom.h"
+#include <string.h>
+
+#define OFFSET_MAGIC    0
+#define OFFSET_LENGTH   2
+#define OFFSET_SEQUENCE 4
+#define OFFSET_CRC      8
+
+static const uint32_t eeprom_page[2] = { EEPROM_PAGE0_ADDRESS, EEPROM_PAGE1_ADDRESS };
+
+static uint8_t eeprom_active = 0;              // Page the next record goes to
+static uint8_t eeprom_next = 0;                // Next free slot in the active page, EEPROM_SLOTS = full
+static const uint8_t* eeprom_newest = NULL;    // Newest valid record
+
+volatile uint32_t eeprom_sequence = 0;
+volatile uint32_t eeprom_appends = 0;
+volatile uint32_t eeprom_erases = 0;
+volatile uint32_t eeprom_torn = 0;
+
+
+static const uint8_t* Slot(uint8_t page, uint8_t slot) {
+    return (const uint8_t*)(eeprom_page[page] + (uint32_t)slot * EEPROM_SLOT_SIZE);
+}
+
+
+static uint16_t Get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+
+static uint32_t Get32(const uint8_t* p) {
+    return (uint32_t)Get16(p) | ((uint32_t)Get16(p + 2) << 16);
+}
+
+
+// CRC of a record, length and sequence included so a record cannot be mistaken for another one
+static uint16_t RecordCrc(const uint8_t* header, const uint8_t* payload) {
+    uint16_t crc = EEPROM_Crc16(EEPROM_CRC_INIT, &header[OFFSET_LENGTH], 6);
+    return EEPROM_Crc16(crc, payload, Get16(&header[OFFSET_LENGTH]));
+}
+
+
+static uint8_t SlotErased(const uint8_t* slot) {
+    const uint32_t* p = (const uint32_t*)slot;
+    for (int i = 0; i < EEPROM_SLOT_SIZE / 4; i++) {
+        if (p[i] != 0xFFFFFFFF) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+static uint8_t SlotValid(const uint8_t* slot) {
+    return Get16(&slot[OFFSET_MAGIC]) == EEPROM_RECORD_MAGIC
+        && Get16(&slot[OFFSET_LENGTH]) <= EEPROM_RECORD_MAX
+        && Get16(&slot[OFFSET_CRC]) == RecordCrc(slot, &slot[EEPROM_HEADER_SIZE]);
+}
+
+
+// Find the newest record and the next free slot, call once at boot before EEPROM_Read/EEPROM_Append
+void EEPROM_Init(void) {
+    uint8_t last_used[2] = { 0, 0 };   // One past the last written slot, per page
+
+    eeprom_newest = NULL;
+    eeprom_sequence = 0;
+    eeprom_active = 0;
+
+    for (uint8_t page = 0; page < 2; page++) {
+        for (uint8_t slot = 0; slot < EEPROM_SLOTS; slot++) {
+            const uint8_t* p = Slot(page, slot);
+
+            if (Get16(&p[OFFSET_MAGIC]) == 0xFFFF && SlotErased(p)) {
+                continue;
+            }
+            last_used[page] = slot + 1;
+
+            if (!SlotValid(p)) {
+                eeprom_torn++;
+                continue;
+            }
+
+            uint32_t sequence = Get32(&p[OFFSET_SEQUENCE]);
+            if (eeprom_newest == NULL || sequence > eeprom_sequence) {
+                eeprom_newest = p;
+                eeprom_sequence = sequence;
+                eeprom_active = page;
+            }
+        }
+    }
+
+    // Append after anything already written in the active page, torn slots are skipped, not reused
+    eeprom_next = last_used[eeprom_active];
+}
+
+
+// Copy the newest record's payload, returns its length or 0 if there is no record
+uint16_t EEPROM_Read(void* data, uint16_t size) {
+    if (eeprom_newest == NULL) {
+        return 0;
+    }
+
+    uint16_t length = Get16(&eeprom_newest[OFFSET_LENGTH]);
+    memcpy(data, &eeprom_newest[EEPROM_HEADER_SIZE], length < size ? length : size);
+    return length;
+}
+
+
+static HAL_StatusTypeDef ErasePage(uint32_t address) {
+    FLASH_EraseInitTypeDef eraseInit;
+    uint32_t pageError;
+
+    eraseInit.TypeErase = FLASH_TYPEERASE_PAGES;
+    eraseInit.PageAddress = address;
+    eraseInit.NbPages = 1;
+
+    eeprom_erases++;
+    return HAL_FLASHEx_Erase(&eraseInit, &pageError);
+}
+
+
+static HAL_StatusTypeDef Program(uint32_t address, const uint8_t* data, uint16_t length) {
+    HAL_StatusTypeDef status = HAL_OK;
+    for (uint16_t i = 0; i < length && status == HAL_OK; i += 2) {
+        uint16_t half = (uint16_t)(data[i] | ((i + 1 < length ? data[i + 1] : 0xFF) << 8));
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, address + i, half);
+    }
+    return status;
+}
+
+
+// Append a new record, becomes the newest one if it reads back valid
+HAL_StatusTypeDef EEPROM_Append(const void* data, uint16_t length) {
+    if (length > EEPROM_RECORD_MAX) {
+        return HAL_ERROR;
+    }
+
+    uint8_t header[EEPROM_HEADER_SIZE];
+    uint32_t sequence = eeprom_sequence + 1;
+    memset(header, 0xFF, sizeof(header));
+    header[OFFSET_LENGTH] = (uint8_t)length;
+    header[OFFSET_LENGTH + 1] = (uint8_t)(length >> 8);
+    for (int i = 0; i < 4; i++) {
+        header[OFFSET_SEQUENCE + i] = (uint8_t)(sequence >> (8 * i));
+    }
+    uint16_t crc = RecordCrc(header, (const uint8_t*)data);
+    header[OFFSET_CRC] = (uint8_t)crc;
+    header[OFFSET_CRC + 1] = (uint8_t)(crc >> 8);
+
+    HAL_FLASH_Unlock();
+
+    HAL_StatusTypeDef status = HAL_OK;
+    if (eeprom_next >= EEPROM_SLOTS) {
+        // Active page full, carry on in the other one
+        eeprom_active ^= 1;
+        eeprom_next = 0;
+        status = ErasePage(eeprom_page[eeprom_active]);
+    }
+
+    uint32_t slot = (uint32_t)Slot(eeprom_active, eeprom_next);
+    eeprom_next++;                  // Used from here on, even if the write fails
+
+    // Payload and header fields first, the magic last commits the record
+    if (status == HAL_OK) status = Program(slot + OFFSET_LENGTH, &header[OFFSET_LENGTH], OFFSET_CRC + 2 - OFFSET_LENGTH);
+    if (status == HAL_OK) status = Program(slot + EEPROM_HEADER_SIZE, (const uint8_t*)data, length);
+    if (status == HAL_OK) status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, slot + OFFSET_MAGIC, EEPROM_RECORD_MAGIC);
+
+    HAL_FLASH_Lock();
+
+    if (status != HAL_OK || !SlotValid((const uint8_t*)slot)) {
+        return HAL_ERROR;
+    }
+
+    eeprom_newest = (const uint8_t*)slot;
+    eeprom_sequence = sequence;
+    eeprom_appends++;
+    return HAL_OK;
+}
+
+
+// CRC-16/CCITT (poly 0x1021), continued from crc, start with EEPROM_CRC_INIT. Also used by the
+// settings record for its own CRC.
+uint16_t EEPROM_Crc16(uint16_t crc, const uint8_t* data, uint16_t length) {
+    while (length--) {
+        crc ^= (uint16_t)(*data++ << 8);
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,155 @@
+/**
+  ******************************************************************************
+  * @file    filter.c
+  * @brief   This file provides code for the multi-scan
+  *          consensus filter between capture and decode
+  ******************************************************************************
+*/
+
+// A glitchy capture shows up as a cell that changes for a single scan and then goes back.
+// Each packet (one character cell) is split into its character bits and its annunciator bit,
+// and each part is only committed to the output frame once the new value has been seen in
+// FILTER_STABLE_SCANS consecutive scans. The R6243 scans at ~111 Hz while the TFT is only
+// redrawn every 35 ms, so there are several scans to spend on every rendered frame.
+//
+// Packet layout (see Packets_to_chars): byte 2 bit 6 is the annunciator (S36), all other
+// bits belong to the character bitmap.
+
+#include "filter.h"
+#include "decode.h"
+#include <string.h>
+
+#define ANNUNC_BYTE     2
+#define ANNUNC_MASK     0x40
+
+// Committed frame handed to the decoder
+static uint8_t filter_committed[CAPTURE_FRAME_SIZE];
+
+// Per packet candidate values and how many consecutive scans they have been seen
+static uint8_t filter_candidate[CAPTURE_FRAME_SIZE];
+static uint8_t filter_char_count[PACKET_COUNT];
+static uint8_t filter_annunc_count[PACKET_COUNT];
+static uint8_t filter_primed = 0;
+
+// Scan edge time (Timer_Stamp() cycles) at which each candidate was first seen, and the earliest one committed by
+// the last Filter_Frame() call. Lets the latency measurement start from the scan the change first showed up in.
+static uint32_t filter_char_seen[PACKET_COUNT];
+static uint32_t filter_annunc_seen[PACKET_COUNT];
+static uint8_t filter_changed = 0;
+static uint32_t filter_changed_seen = 0;
+
+// Filter statistics
+volatile uint32_t filter_changes_committed = 0;
+volatile uint32_t filter_changes_rejected = 0;
+
+
+// Compare the character part of two packets (annunciator bit ignored)
+static uint8_t SameChar(const uint8_t* a, const uint8_t* b) {
+    return a[0] == b[0] && a[1] == b[1] && ((a[2] ^ b[2]) & ~ANNUNC_MASK) == 0 && a[3] == b[3] && a[4] == b[4];
+}
+
+
+// Copy the character part of a packet, leaving the annunciator bit of the destination alone
+static void CopyChar(uint8_t* dst, const uint8_t* src) {
+    dst[0] = src[0];
+    dst[1] = src[1];
+    dst[2] = (dst[2] & ANNUNC_MASK) | (src[2] & ~ANNUNC_MASK);
+    dst[3] = src[3];
+    dst[4] = src[4];
+}
+
+
+// Note a committed change first seen at time seen
+static void Changed(uint32_t seen) {
+    if (!filter_changed || (int32_t)(seen - filter_changed_seen) < 0) {
+        filter_changed_seen = seen;
+    }
+    filter_changed = 1;
+}
+
+
+// Run one captured frame through the filter and return the committed frame to decode.
+// time is the Timer_Stamp() of the scan edge the frame started at.
+const uint8_t* Filter_Frame(const uint8_t* frame, uint32_t time) {
+
+    filter_changed = 0;
+
+    // First frame after boot is taken as-is
+    if (!filter_primed || FILTER_STABLE_SCANS <= 1) {
+        if (memcmp(filter_committed, frame, CAPTURE_FRAME_SIZE) != 0 || !filter_primed) {
+            Changed(time);
+        }
+        memcpy(filter_committed, frame, CAPTURE_FRAME_SIZE);
+        filter_primed = 1;
+        return filter_committed;
+    }
+
+    for (int i = 0; i < PACKET_COUNT; i++) {
+        const uint8_t* in = &frame[i * PACKET_WIDTH];
+        uint8_t* out = &filter_committed[i * PACKET_WIDTH];
+        uint8_t* cand = &filter_candidate[i * PACKET_WIDTH];
+        uint8_t bypass = (uint8_t)((FILTER_BYPASS_CELLS >> Reorder[i]) & 1);
+
+        // Character bits
+        if (SameChar(in, out)) {
+            if (filter_char_count[i] != 0) {
+                filter_changes_rejected++;          // Candidate did not persist
+                filter_char_count[i] = 0;
+            }
+        }
+        else if (bypass) {
+            CopyChar(out, in);
+            filter_changes_committed++;
+            Changed(time);
+        }
+        else {
+            if (filter_char_count[i] != 0 && SameChar(in, cand)) {
+                filter_char_count[i]++;
+            }
+            else {
+                if (filter_char_count[i] != 0) {
+                    filter_changes_rejected++;      // Replaced by a different candidate
+                }
+                CopyChar(cand, in);
+                filter_char_count[i] = 1;
+                filter_char_seen[i] = time;
+            }
+
+            if (filter_char_count[i] >= FILTER_STABLE_SCANS) {
+                CopyChar(out, in);
+                filter_char_count[i] = 0;
+                filter_changes_committed++;
+                Changed(filter_char_seen[i]);
+            }
+        }
+
+        // Annunciator bit
+        uint8_t annunc = in[ANNUNC_BYTE] & ANNUNC_MASK;
+        if (annunc == (out[ANNUNC_BYTE] & ANNUNC_MASK)) {
+            if (filter_annunc_count[i] != 0) {
+                filter_changes_rejected++;
+                filter_annunc_count[i] = 0;
+            }
+        }
+        else {
+            if (filter_annunc_count[i] == 0) {
+                filter_annunc_seen[i] = time;
+            }
+            if (bypass || ++filter_annunc_count[i] >= FILTER_STABLE_SCANS) {
+                out[ANNUNC_BYTE] = (out[ANNUNC_BYTE] & ~ANNUNC_MASK) | annunc;
+                filter_annunc_count[i] = 0;
+                filter_changes_committed++;
+                Changed(filter_annunc_seen[i]);
+            }
+        }
+    }
+
+    return filter_committed;
+}
+
+
+// 1 if the last Filter_Frame() call committed a change, first_seen = scan edge time it first showed up
+uint8_t Filter_Changed(uint32_t* first_seen) {
+    *first_seen = filter_changed_seen;
+    return filter_changed;
+}
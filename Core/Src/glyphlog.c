@@ -0,0 +1,69 @@
+/**
+  ******************************************************************************
+  * @file    glyphlog.c
+  * @brief   This file provides code for logging bitmaps
+  *          not found in the font table
+  ******************************************************************************
+*/
+
+// BitmapToChar() calls GlyphLog_Record() only after the font table search has failed,
+// so a matched character costs nothing extra. Each distinct unmatched bitmap gets one
+// entry with a hit count and the G position it was first seen at. The dump prints every
+// entry in the same format as bitmap_characters[] so it can be pasted straight into decode.c
+// once the right character has been filled in.
+
+#include "glyphlog.h"
+#include "debug.h"
+#include <string.h>
+
+GlyphLogEntry glyph_log[GLYPH_LOG_SIZE];
+volatile uint8_t glyph_log_count = 0;
+volatile uint32_t glyph_log_misses = 0;
+volatile uint32_t glyph_log_dropped = 0;
+
+
+// Record a bitmap that BitmapToChar() could not match
+void GlyphLog_Record(const uint8_t* bitmap, uint8_t position) {
+    glyph_log_misses++;
+
+    for (int i = 0; i < glyph_log_count; i++) {
+        if (memcmp(glyph_log[i].bitmap, bitmap, CHAR_HEIGHT) == 0) {
+            glyph_log[i].hits++;
+            return;
+        }
+    }
+
+    if (glyph_log_count >= GLYPH_LOG_SIZE) {
+        glyph_log_dropped++;
+        return;
+    }
+
+    GlyphLogEntry* entry = &glyph_log[glyph_log_count];
+    memcpy(entry->bitmap, bitmap, CHAR_HEIGHT);
+    entry->first_position = position;
+    entry->hits = 1;
+    glyph_log_count++;
+}
+
+
+// Forget everything logged so far
+void GlyphLog_Clear(void) {
+    glyph_log_count = 0;
+    glyph_log_misses = 0;
+    glyph_log_dropped = 0;
+}
+
+
+// Print the log over the debug channel
+void GlyphLog_Dump(void) {
+    Debug_Printf("Glyph log: %u entries, %lu misses, %lu dropped\n",
+        (unsigned)glyph_log_count, (unsigned long)glyph_log_misses, (unsigned long)glyph_log_dropped);
+
+    for (int i = 0; i < glyph_log_count; i++) {
+        const GlyphLogEntry* entry = &glyph_log[i];
+        Debug_Printf("\t{{0x%02X, 0x%02X, 0x%02X, 0x%02X, 0x%02X, 0x%02X, 0x%02X}, '?'},  // G%u, %lu hits\n",
+            entry->bitmap[0], entry->bitmap[1], entry->bitmap[2], entry->bitmap[3],
+            entry->bitmap[4], entry->bitmap[5], entry->bitmap[6],
+            (unsigned)entry->first_position, (unsigned long)entry->hits);
+    }
+}
@@ -119,7 +119,7 @@ void MX_GPIO_Init(void) {
     //HAL_GPIO_Init(LT7680_SPI_MISO_PORT, &GPIO_InitStruct);
 
     /* EXTI interrupt init */
-    HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(EXTI15_10_IRQn, IRQ_PRIO_SCAN_EDGE, 0);
     HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
 
 }
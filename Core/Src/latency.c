@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file    latency.c
+  * @brief   This file provides code for the glass-to-glass
+  *          update latency histogram
+  ******************************************************************************
+*/
+
+// Measures how long a change on the VFD takes to reach the TFT. The clock starts at the scan edge the
+// change was first captured in (Timer_Stamp() taken in the EXTI ISR, carried with the frame through the
+// filter, which keeps the first-seen stamp of each cell while it waits for the change to be stable).
+// It stops when the render pass that draws it has made its last LT7680 register write.
+//
+// Several changes committed before the same render pass count once, from the earliest of them.
+//
+//   Latency_Change()   - from the deferred decode, for each frame that committed a change
+//   Latency_Rendered() - from the main loop, at the end of each render pass
+
+#include "latency.h"
+#include "timer.h"
+#include "debug.h"
+#include "stm32f1xx_hal.h"
+
+static volatile uint8_t latency_pending = 0;
+static volatile uint32_t latency_seen = 0;        // Timer_Stamp() of the earliest change not yet rendered
+
+volatile uint32_t latency_histogram[LATENCY_BUCKETS];
+volatile uint32_t latency_count = 0;
+volatile uint32_t latency_min_us = 0;
+volatile uint32_t latency_max_us = 0;
+volatile uint32_t latency_p95_us = 0;
+volatile uint32_t latency_p99_us = 0;
+
+
+// Bucket of a latency in us: octave from the top bit, then the next LATENCY_SUB_BITS bits
+static uint8_t Bucket(uint32_t us) {
+    if (us < (1U << LATENCY_SUB_BITS)) {
+        return (uint8_t)us;
+    }
+    uint32_t octave = 31 - __CLZ(us);
+    uint32_t sub = (us >> (octave - LATENCY_SUB_BITS)) & ((1U << LATENCY_SUB_BITS) - 1);
+    uint32_t bucket = ((octave - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) + sub;
+    return bucket < LATENCY_BUCKETS ? (uint8_t)bucket : LATENCY_BUCKETS - 1;
+}
+
+
+// Highest latency in us that falls into a bucket
+static uint32_t BucketTop(uint8_t bucket) {
+    if (bucket < (1U << LATENCY_SUB_BITS)) {
+        return bucket;
+    }
+    uint32_t octave = (bucket >> LATENCY_SUB_BITS) + LATENCY_SUB_BITS - 1;
+    uint32_t sub = bucket & ((1U << LATENCY_SUB_BITS) - 1);
+    return ((((1U << LATENCY_SUB_BITS) + sub + 1)) << (octave - LATENCY_SUB_BITS)) - 1;
+}
+
+
+// Latency that permille of the records are at or below, upper edge of its bucket
+static uint32_t Percentile(uint32_t permille) {
+    uint32_t target = (uint32_t)(((uint64_t)latency_count * permille + 999) / 1000);
+    uint32_t sum = 0;
+
+    for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+        sum += latency_histogram[i];
+        if (sum >= target && sum != 0) {
+            return BucketTop(i);
+        }
+    }
+    return 0;
+}
+
+
+// A decoded frame committed a change first captured at Timer_Stamp() time seen
+void Latency_Change(uint32_t seen) {
+    if (!latency_pending) {
+        latency_seen = seen;
+        latency_pending = 1;
+    }
+}
+
+
+// A render pass has finished, the pending change (if any) is now on the glass
+void Latency_Rendered(void) {
+    if (!latency_pending) {
+        return;
+    }
+
+    uint32_t us = (Timer_Stamp() - latency_seen) / (SystemCoreClock / 1000000);
+    latency_pending = 0;
+
+    latency_histogram[Bucket(us)]++;
+    if (latency_count == 0 || us < latency_min_us) {
+        latency_min_us = us;
+    }
+    if (us > latency_max_us) {
+        latency_max_us = us;
+    }
+    latency_count++;
+
+    latency_p95_us = Percentile(950);
+    latency_p99_us = Percentile(990);
+}
+
+
+void Latency_Clear(void) {
+    for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+        latency_histogram[i] = 0;
+    }
+    latency_count = 0;
+    latency_min_us = 0;
+    latency_max_us = 0;
+    latency_p95_us = 0;
+    latency_p99_us = 0;
+}
+
+
+// Print the summary and the non-empty buckets on the debug channel
+void Latency_Dump(void) {
+    Debug_Printf("Latency: %lu updates, min %lu us, p50 %lu us, p95 %lu us, p99 %lu us, max %lu us\n",
+        (unsigned long)latency_count, (unsigned long)latency_min_us, (unsigned long)Percentile(500),
+        (unsigned long)latency_p95_us, (unsigned long)latency_p99_us, (unsigned long)latency_max_us);
+
+    for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+        if (latency_histogram[i] != 0) {
+            Debug_Printf("  <= %7lu us %8lu\n", (unsigned long)BucketTop(i), (unsigned long)latency_histogram[i]);
+        }
+    }
+}
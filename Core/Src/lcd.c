@@ -16,52 +16,120 @@
 #include "main.h"
 #include "lcd.h"
 #include "lt7680.h"
+#include "timer.h"
+#include "trace.h"
+#include <stddef.h>
 
 
 //************************************************************************************************************************************************************
 
 // Bit bang SPI to LCD (9bit)
-void LCD_SPI_Write(uint16_t data, uint8_t bits) {
-	for (int i = bits - 1; i >= 0; i--) {  // Loop through each bit (MSB first)
-		// Set SDA based on the current bit
-		if (data & (1 << i)) {
-			HAL_GPIO_WritePin(LCD_SDI_Port, LCD_SDI_Pin, GPIO_PIN_SET);  // SDA = 1
-		}
-		else {
-			HAL_GPIO_WritePin(LCD_SDI_Port, LCD_SDI_Pin, GPIO_PIN_RESET); // SDA = 0
-		}
+//
+// The pins are driven through BSRR, one store per edge, and each half clock is timed from the DWT
+// cycle counter, so the clock rate no longer depends on HAL call overhead. CS is held low for a whole
+// command and its payload (LCD_WriteCommand), the ST7701S only needs CS high between commands.
+
+#define LCD_CS_LOW()		(LCD_CS_Port->BSRR = (uint32_t)LCD_CS_Pin << 16)
+#define LCD_CS_HIGH()		(LCD_CS_Port->BSRR = LCD_CS_Pin)
+#define LCD_SCK_LOW()		(LCD_SCK_Port->BSRR = (uint32_t)LCD_SCK_Pin << 16)
+#define LCD_SCK_HIGH()		(LCD_SCK_Port->BSRR = LCD_SCK_Pin)
+
+static uint32_t lcd_half_cycles = 0;		// CPU cycles per half clock, set on first use
+static uint8_t lcd_dwt_counting = 0;		// 0 = DWT cycle counter stuck, half clocks fall back to a loop
+
+volatile uint32_t lcd_words_per_sec = 0;		// Last LCD_Benchmark() results
+volatile uint32_t lcd_words_per_sec_legacy = 0;
+
+
+// Wait from 'start' until a half clock has passed, returns the new start. If the half clock has already
+// passed (pre-empted by an interrupt) the next one is timed from now, so edges never bunch up to catch up.
+static inline uint32_t HalfClock(uint32_t start) {
+	if (!lcd_dwt_counting) {
+		for (volatile uint32_t n = lcd_half_cycles; n != 0; n--);	// Several cycles per pass, never short
+		return start;
+	}
 
-		// Toggle the clock signal
-		HAL_GPIO_WritePin(LCD_SCK_Port, LCD_SCK_Pin, GPIO_PIN_SET); // CLK high
-		DelayMicroseconds(5);                                   // Hold high
-		HAL_GPIO_WritePin(LCD_SCK_Port, LCD_SCK_Pin, GPIO_PIN_RESET); // CLK low
-		DelayMicroseconds(5);                                   // Hold low
+	uint32_t now = DWT_GetCycles();
+	if ((now - start) >= lcd_half_cycles) {
+		return now;
 	}
+	while ((DWT_GetCycles() - start) < lcd_half_cycles);
+	return start + lcd_half_cycles;
 }
 
 
-void LCDWriteRegister(uint8_t reg) {
-	HAL_GPIO_WritePin(LCD_CS_Port, LCD_CS_Pin, GPIO_PIN_RESET); // Pull CS low
-	DelayMicroseconds(10);
+// Clock one 9-bit word out, MSB (D/CX) first. CS must already be low.
+static void WriteWord(uint16_t word) {
+	uint32_t t = DWT_GetCycles();
+
+	for (int i = 8; i >= 0; i--) {
+		// SDA changes while SCK is low, the ST7701S samples it on the rising edge
+		LCD_SDI_Port->BSRR = (word & (1 << i)) ? LCD_SDI_Pin : ((uint32_t)LCD_SDI_Pin << 16);
+		t = HalfClock(t);
+		LCD_SCK_HIGH();
+		t = HalfClock(t);
+		LCD_SCK_LOW();
+	}
+	HalfClock(t);
+}
+
+
+static void TransportInit(void) {
+	if (lcd_half_cycles == 0) {
+		lcd_half_cycles = (SystemCoreClock / 1000000 * LCD_HALF_CLOCK_NS + 999) / 1000;
+
+		// A part whose DWT does not count would otherwise hang the panel init in HalfClock()
+		uint32_t before = DWT_GetCycles();
+		for (volatile int n = 0; n < 16; n++);
+		lcd_dwt_counting = DWT_GetCycles() != before;
+	}
+}
 
-	// Use LCD_SPI_Write for 9-bit SPI communication
-	LCD_SPI_Write((0 << 8) | reg, 9); // D/CX = 0, reg[7:0]
 
-	HAL_GPIO_WritePin(LCD_CS_Port, LCD_CS_Pin, GPIO_PIN_SET);   // Pull CS high
-	DelayMicroseconds(10);
+// Bit bang 'bits' bits of data, MSB first, CS is left to the caller
+void LCD_SPI_Write(uint16_t data, uint8_t bits) {
+	TransportInit();
+
+	uint32_t t = DWT_GetCycles();
+	for (int i = bits - 1; i >= 0; i--) {
+		LCD_SDI_Port->BSRR = (data & (1 << i)) ? LCD_SDI_Pin : ((uint32_t)LCD_SDI_Pin << 16);
+		t = HalfClock(t);
+		LCD_SCK_HIGH();
+		t = HalfClock(t);
+		LCD_SCK_LOW();
+	}
 }
 
 
+// Command and its payload in one CS low period
+void LCD_WriteCommand(uint8_t command, const uint8_t* data, uint8_t length) {
+	TransportInit();
+
+	LCD_CS_LOW();
+	HalfClock(DWT_GetCycles());
+	WriteWord((0 << 8) | command);                  // D/CX = 0, command
+	for (uint8_t n = 0; n < length; n++) {
+		WriteWord((1 << 8) | data[n]);              // D/CX = 1, data
+	}
+	LCD_CS_HIGH();
+	HalfClock(DWT_GetCycles());
+}
 
-void LCDWriteData(uint8_t data) {
-	HAL_GPIO_WritePin(LCD_CS_Port, LCD_CS_Pin, GPIO_PIN_RESET); // Pull CS low
-	DelayMicroseconds(10);
 
-	// Use LCD_SPI_Write for 9-bit SPI communication
-	LCD_SPI_Write((1 << 8) | data, 9); // D/CX = 1, data[7:0]
+void LCDWriteRegister(uint8_t reg) {
+	LCD_WriteCommand(reg, NULL, 0);
+}
+
+
+// A data byte on its own, as a continuation of the last command
+void LCDWriteData(uint8_t data) {
+	TransportInit();
 
-	HAL_GPIO_WritePin(LCD_CS_Port, LCD_CS_Pin, GPIO_PIN_SET);   // Pull CS high
-	DelayMicroseconds(10);
+	LCD_CS_LOW();
+	HalfClock(DWT_GetCycles());
+	WriteWord((1 << 8) | data);                     // D/CX = 1, data[7:0]
+	LCD_CS_HIGH();
+	HalfClock(DWT_GetCycles());
 }
 
 
@@ -69,7 +137,7 @@ void LCDWriteData(uint8_t data) {
 // delay used by the bit bang SPI	
 void DelayMicroseconds(uint16_t us) {
 	uint32_t start = SysTick->VAL; // Get current SysTick value
-	uint32_t ticks = (HAL_RCC_GetHCLKFreq() / 1000000) * us; // Ticks for desired delay
+	uint32_t ticks = (SystemCoreClock / 1000000) * us; // Ticks for desired delay
 	uint32_t reload = SysTick->LOAD + 1;
 
 	while (((start - SysTick->VAL) & 0xFFFFFF) < ticks) {
@@ -80,6 +148,61 @@ void DelayMicroseconds(uint16_t us) {
 }
 
 
+#if LCD_BENCHMARK_ENABLED
+
+// DelayMicroseconds() as it was, reading the HCLK frequency through HAL on every call
+static void LegacyDelayMicroseconds(uint16_t us) {
+	uint32_t start = SysTick->VAL;
+	uint32_t ticks = (HAL_RCC_GetHCLKFreq() / 1000000) * us;
+	uint32_t reload = SysTick->LOAD + 1;
+
+	while (((start - SysTick->VAL) & 0xFFFFFF) < ticks) {
+		if (SysTick->VAL > reload) {
+			start -= reload;
+		}
+	}
+}
+
+
+// The transport as it was: HAL pin writes, 5 us half clocks and 10 us CS guards around every word
+static void LegacyWriteWord(uint16_t word) {
+	HAL_GPIO_WritePin(LCD_CS_Port, LCD_CS_Pin, GPIO_PIN_RESET);
+	LegacyDelayMicroseconds(10);
+	for (int i = 8; i >= 0; i--) {
+		HAL_GPIO_WritePin(LCD_SDI_Port, LCD_SDI_Pin, (word & (1 << i)) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+		HAL_GPIO_WritePin(LCD_SCK_Port, LCD_SCK_Pin, GPIO_PIN_SET);
+		LegacyDelayMicroseconds(5);
+		HAL_GPIO_WritePin(LCD_SCK_Port, LCD_SCK_Pin, GPIO_PIN_RESET);
+		LegacyDelayMicroseconds(5);
+	}
+	HAL_GPIO_WritePin(LCD_CS_Port, LCD_CS_Pin, GPIO_PIN_SET);
+	LegacyDelayMicroseconds(10);
+}
+
+
+// Words per second for the old and new transport. Sends ST7701S NOPs (0x00), which the panel ignores.
+// The new transport streams them as one command with LCD_BENCHMARK_WORDS - 1 payload words.
+void LCD_Benchmark(void) {
+	static const uint8_t zeros[LCD_BENCHMARK_WORDS - 1] = { 0 };
+	uint8_t traced = Trace_ReleasePin();		// PB3 is LCD_CS while this runs
+	uint32_t start;
+
+	start = DWT_GetCycles();
+	for (int i = 0; i < LCD_BENCHMARK_WORDS; i++) {
+		LegacyWriteWord(0x000);
+	}
+	lcd_words_per_sec_legacy = (uint32_t)((uint64_t)LCD_BENCHMARK_WORDS * SystemCoreClock / (DWT_GetCycles() - start));
+
+	start = DWT_GetCycles();
+	LCD_WriteCommand(0x00, zeros, sizeof(zeros));
+	lcd_words_per_sec = (uint32_t)((uint64_t)LCD_BENCHMARK_WORDS * SystemCoreClock / (DWT_GetCycles() - start));
+
+	Trace_RestorePin(traced);
+}
+
+#endif
+
+
 //**************************************************************************************************
 // Commands to LCD
 
@@ -125,555 +248,151 @@ void LCD_Hor_Ver_Timing() {
 }
 
 
-void AdaFruit_Init() {
+//**************************************************************************************************
+// ST7701S init sequences
+//
+// Each entry is: command, payload length, payload bytes. LCD_INIT_DELAY in the length adds one more
+// byte, a delay in ms after the command. Adding a panel is a new table plus a one line init function.
+
+// AdaFruit - ST7701S+AUO4.58
+// https://cdn-shop.adafruit.com/product-files/5805/AUO4.58-ST7701S-3W-RGB18BIT_initcode.txt
+static const uint8_t adafruit_init[] = {
+	0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x13,
+	0xEF, 1, 0x08,
+	0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x10,
+	// C1 (porch) is commented out in the vendor code, so its VBPD 0x09 / VFPD 0x08 go to C0 as bytes 3 and 4.
+	// 0x77 - GAMALOT made this 0x79 to help stability of first line
+	0xC0, 4, 0x77, 0x00, 0x09, 0x08,
+	0xC2, 2, 0x01, 0x02,									// inv
+	0xC3, 1, 0x02,											// 82 HVmode    02 DEmode
+	0xCC, 1, 0x10,
+	0xB0, 16, 0x40, 0x14, 0x59, 0x10, 0x12, 0x08, 0x03, 0x09, 0x05, 0x1E, 0x05, 0x14, 0x10, 0x68, 0x33, 0x15,
+	0xB1, 16, 0x40, 0x08, 0x53, 0x09, 0x11, 0x09, 0x02, 0x07, 0x09, 0x1A, 0x04, 0x12, 0x12, 0x64, 0x29, 0x29,
+	0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x11,
+	0xB0, 1, 0x6D,
+	0xB1, 1, 0x1D,											// vcom
+	0xB2, 1, 0x87,
+	0xB3, 1, 0x80,
+	0xB5, 1, 0x49,
+	0xB7, 1, 0x85,
+	0xB8, 1, 0x20,
+	0xC1, 1, 0x78,
+	0xC2, 1, 0x78,
+	0xD0, 1, 0x88,
+	0xE0, 3, 0x00, 0x00, 0x02,
+	0xE1, 11, 0x02, 0x8C, 0x00, 0x00, 0x03, 0x8C, 0x00, 0x00, 0x00, 0x33, 0x33,
+	0xE2, 13, 0x33, 0x33, 0x33, 0x33, 0xC9, 0x3C, 0x00, 0x00, 0xCA, 0x3C, 0x00, 0x00, 0x00,
+	0xE3, 4, 0x00, 0x00, 0x33, 0x33,
+	0xE4, 2, 0x44, 0x44,
+	0xE5, 16, 0x05, 0xCD, 0x82, 0x82, 0x01, 0xC9, 0x82, 0x82, 0x07, 0xCF, 0x82, 0x82, 0x03, 0xCB, 0x82, 0x82,
+	0xE6, 4, 0x00, 0x00, 0x33, 0x33,
+	0xE7, 2, 0x44, 0x44,
+	0xE8, 16, 0x06, 0xCE, 0x82, 0x82, 0x02, 0xCA, 0x82, 0x82, 0x08, 0xD0, 0x82, 0x82, 0x04, 0xCC, 0x82, 0x82,
+	0xEB, 7, 0x08, 0x01, 0xE4, 0xE4, 0x88, 0x00, 0x40,
+	0xEC, 3, 0x00, 0x00, 0x00,
+	0xED, 16, 0xFF, 0xF0, 0x07, 0x65, 0x4F, 0xFC, 0xC2, 0x2F, 0xF2, 0x2C, 0xCF, 0xF4, 0x56, 0x70, 0x0F, 0xFF,
+	0xEF, 6, 0x10, 0x0D, 0x04, 0x08, 0x3F, 0x1F,
+	0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x00,
+	0x11, LCD_INIT_DELAY | 0, 120,							// Sleep out
+	0x35, 1, 0x00,
+	0x3A, 1, 0x66,
+	0x29, 0,
+};
+
+
+// BuyDisplay - refer to ST7701S datasheet and your TFT LCD datasheet in order to make the following settings
+
+// NRCTRL (E1h) and SECTRL (E2h) byte 1: enable (1/0) and level (0b00, 0b01, 0b10, 0b11)
+#define BUY_NR_BYTE1(enable, level)		((uint8_t)(((enable) ? (1 << 4) : 0x00) | ((level) & 0x03)))
+#define BUY_SC_BYTE1(enable, level)		((uint8_t)(((enable) ? (1 << 4) : 0x00) | ((level) & 0x03)))
+
+static const uint8_t buydisplay_init[] = {
+	0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x13,					// CND2BKxSEL: Command2 BK3 Selection - Command bank selection - Bank 3
+	0xEF, 1, 0x08,											// not known
+	0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x10,					// CND2BKxSEL: Command2 BK0 Selection - Command bank selection - Bank 0 (system)
+	0xC0, 2, 0x77, 0x00,									// LNESET: Display Line Setting - 960 lines
+	0xC1, 2, 0x0A, 0x0C,									// PORCTRL: Porch Control - VBP = 10, VFP = 12
+	0xC2, 2, 0x37, 0x08,									// INVSET: Inversion NLINV = 7 (originally 37), Frame Rate Control RTNI = 8 (originally 0x02, tried 0x00)
+	0xC3, 3, 0x81, 0x38, 0x22,								// RGBCTRL: DE/HV=HV, VSP=L, HSP=L, DP=Rising, EP=High; HBP_HVRGB (originally 0x05); VBP_HVRGB (originally 0x0D)
+	0xCC, 1, 0x10,											// not known
+	0xB0, 16, 0x40, 0x14, 0x59, 0x10, 0x12, 0x08, 0x03, 0x09, 0x05, 0x1E, 0x05, 0x14, 0x10, 0x68, 0x33, 0x15,		// PVGAMCTRL: Positive Voltage Gamma Control
+	0xB1, 16, 0x40, 0x08, 0x53, 0x09, 0x11, 0x09, 0x02, 0x07, 0x09, 0x1A, 0x04, 0x12, 0x12, 0x64, 0x29, 0x29,		// NVGAMCTRL: Negative Voltage Gamma Control
+	0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x11,					// CND2BKxSEL: Command2 BK1 Selection - Command bank selection - Bank 1
+	0xB0, 1, 0x6D,											// BK1: VRHS: Vop Amplitude setting - VRHA = 109, 4.9Vdc
+	0xB1, 1, 0x1D,											// VCOMS: VCOM amplitude setting
+	0xB2, 1, 0x87,											// VGHSS: VGH Voltage setting
+	0xB3, 1, 0x00,											// TESTCMD: 0x80 = enable test (if LCD has routine), 0x00 = disable (originally 0x80)
+	0xB5, 1, 0x49,											// VGLS: VGL Voltage setting
+	0xB7, 1, 0x85,											// PWCTRL1: Power Control 1
+	0xB8, 1, 0x20,											// PWCTRL2: Power Control 2
+	0xC1, 1, 0x78,											// SPD1: Source pre_drive timing set1
+	0xC2, 1, 0x78,											// SPD2: Source EQ2 Setting
+	0xD0, 1, 0x88,											// MIPISET1: MIPI Setting 1 - Ignore if LCD is using parallel or SPI comms
+	0xE0, 3, 0x00, 0x00, 0x02,								// SECTRL: Sunlight Readable Enhancement
+	0xE1, 11, BUY_NR_BYTE1(0, 0x02), 0x8C, 0x00, 0x00, 0x03, 0x8C, 0x00, 0x00, 0x00, 0x33, 0x33,				// NRCTRL: Noise Reduce Control, disabled
+	0xE2, 14, BUY_SC_BYTE1(0, 0x02), 0x33, 0x33, 0x33, 0x33, 0xC9, 0x3C, 0x00, 0x00, 0xCA, 0x3C, 0x00, 0x00, 0x00,	// SECTRL: Sharpness Control, disabled
+	0xE3, 4, 0x00, 0x00, 0x33, 0x33,						// CCCTRL: Color Calibration Control
+	0xE4, 2, 0x44, 0x44,									// SKCTRL: Skin Tone Preservation Control
+	0xE5, 16, 0x05, 0xCD, 0x82, 0x82, 0x01, 0xC9, 0x82, 0x82, 0x07, 0xCF, 0x82, 0x82, 0x03, 0xCB, 0x82, 0x82,		// not known
+	0xE6, 4, 0x00, 0x00, 0x33, 0x33,						// not known
+	0xE7, 2, 0x44, 0x44,									// not known
+	0xE8, 16, 0x06, 0xCE, 0x82, 0x82, 0x02, 0xCA, 0x82, 0x82, 0x08, 0xD0, 0x82, 0x82, 0x04, 0xCC, 0x82, 0x82,		// not known
+	0xEB, 7, 0x08, 0x01, 0xE4, 0xE4, 0x88, 0x00, 0x40,		// not known
+	0xEC, 3, 0x00, 0x00, 0x00,								// not known
+	0xED, 16, 0xFF, 0xF0, 0x07, 0x65, 0x4F, 0xFC, 0xC2, 0x2F, 0xF2, 0x2C, 0xCF, 0xF4, 0x56, 0x70, 0x0F, 0xFF,		// not known
+	0xEF, 6, 0x10, 0x0D, 0x04, 0x08, 0x3F, 0x1F,			// not known
+	0xFF, 5, 0x77, 0x01, 0x00, 0x00, 0x00,					// CND2BKxSEL: Disable Bank function
+	0x11, LCD_INIT_DELAY | 0, 120,							// SLPOUT: Sleep Out
+	0x35, 1, 0x00,											// TEON: Tearing Effect Line ON
+	0x3A, 1, 0x55,											// COLMOD: Interface Pixel Format - 16bpp for compatibility with LT7680A-R (0x66 = 18bpp)
+	0x29, 0,												// DISPON: Display On
+};
+
+
+// Send an init table to the ST7701S
+void LCD_RunInitTable(const uint8_t* table, uint16_t size) {
+	uint16_t i = 0;
+	uint8_t traced = Trace_ReleasePin();		// PB3 is LCD_CS while this runs
+
+	while (i < size) {
+		uint8_t command = table[i++];
+		uint8_t length = table[i++];
+
+		uint8_t count = length & ~LCD_INIT_DELAY;
+
+		LCD_WriteCommand(command, &table[i], count);    // Payload streamed straight from flash
+		i += count;
+		if (length & LCD_INIT_DELAY) {
+			HAL_Delay(table[i++]);
+		}
+	}
 
-	//ST7701S+AUO4.58
-	//https://cdn-shop.adafruit.com/product-files/5805/AUO4.58-ST7701S-3W-RGB18BIT_initcode.txt
-
-	LCDWriteRegister(0xFF);
-	LCDWriteData(0x77);
-	LCDWriteData(0x01);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x13);
-
-	LCDWriteRegister(0xEF);
-	LCDWriteData(0x08);
-
-	LCDWriteRegister(0xFF);
-	LCDWriteData(0x77);
-	LCDWriteData(0x01);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x10);
-
-	LCDWriteRegister(0xC0);
-	LCDWriteData(0x77);				// 0x77 - GAMALOT made this 0x79 to help stability of first line
-	LCDWriteData(0x00);
-
-	//uint32_t hexVarVBPD = LCD_VBPD;		// Match the Porch settings from the LT780A-R to the ST7701S
-	//uint32_t hexVarVFPD = LCD_VFPD;
-	//LCDWriteRegister(0xC1);
-	//LCDWriteData((uint8_t)hexVarVBPD);
-	//LCDWriteData((uint8_t)hexVarVFPD);
-	LCDWriteData(0x09);				// VBPD	09
-	LCDWriteData(0x08);				// VFPD 08
-
-	LCDWriteRegister(0xC2);//inv     
-	LCDWriteData(0x01);
-	LCDWriteData(0x02);
-
-	LCDWriteRegister(0xC3); //????    
-	LCDWriteData(0x02); //82 HVmode    02 DEmode 
-
-	LCDWriteRegister(0xCC);
-	LCDWriteData(0x10);
-
-	LCDWriteRegister(0xB0);
-	LCDWriteData(0x40);
-	LCDWriteData(0x14);
-	LCDWriteData(0x59);
-	LCDWriteData(0x10);
-	LCDWriteData(0x12);
-	LCDWriteData(0x08);
-	LCDWriteData(0x03);
-	LCDWriteData(0x09);
-	LCDWriteData(0x05);
-	LCDWriteData(0x1E);
-	LCDWriteData(0x05);
-	LCDWriteData(0x14);
-	LCDWriteData(0x10);
-	LCDWriteData(0x68);
-	LCDWriteData(0x33);
-	LCDWriteData(0x15);
-
-	LCDWriteRegister(0xB1);
-	LCDWriteData(0x40);
-	LCDWriteData(0x08);
-	LCDWriteData(0x53);
-	LCDWriteData(0x09);
-	LCDWriteData(0x11);
-	LCDWriteData(0x09);
-	LCDWriteData(0x02);
-	LCDWriteData(0x07);
-	LCDWriteData(0x09);
-	LCDWriteData(0x1A);
-	LCDWriteData(0x04);
-	LCDWriteData(0x12);
-	LCDWriteData(0x12);
-	LCDWriteData(0x64);
-	LCDWriteData(0x29);
-	LCDWriteData(0x29);
-
-	LCDWriteRegister(0xFF);
-	LCDWriteData(0x77);
-	LCDWriteData(0x01);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x11);
-
-	LCDWriteRegister(0xB0);
-	LCDWriteData(0x6D);  //6D 
-
-	LCDWriteRegister(0xB1);   //vcom  
-	LCDWriteData(0x1D);
-
-	LCDWriteRegister(0xB2);
-	LCDWriteData(0x87);
-
-	LCDWriteRegister(0xB3);
-	LCDWriteData(0x80);
-
-	LCDWriteRegister(0xB5);
-	LCDWriteData(0x49);
-
-	LCDWriteRegister(0xB7);
-	LCDWriteData(0x85);
-
-	LCDWriteRegister(0xB8);
-	LCDWriteData(0x20);
-
-	LCDWriteRegister(0xC1);
-	LCDWriteData(0x78);
-
-	LCDWriteRegister(0xC2);
-	LCDWriteData(0x78);
-
-	LCDWriteRegister(0xD0);
-	LCDWriteData(0x88);
-
-	LCDWriteRegister(0xE0);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x02);
-
-	LCDWriteRegister(0xE1);
-	LCDWriteData(0x02);
-	LCDWriteData(0x8C);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x03);
-	LCDWriteData(0x8C);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x33);
-	LCDWriteData(0x33);
-
-	LCDWriteRegister(0xE2);
-	LCDWriteData(0x33);
-	LCDWriteData(0x33);
-	LCDWriteData(0x33);
-	LCDWriteData(0x33);
-	LCDWriteData(0xC9);
-	LCDWriteData(0x3C);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0xCA);
-	LCDWriteData(0x3C);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-
-	LCDWriteRegister(0xE3);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x33);
-	LCDWriteData(0x33);
-
-	LCDWriteRegister(0xE4);
-	LCDWriteData(0x44);
-	LCDWriteData(0x44);
-
-	LCDWriteRegister(0xE5);
-	LCDWriteData(0x05);
-	LCDWriteData(0xCD);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x01);
-	LCDWriteData(0xC9);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x07);
-	LCDWriteData(0xCF);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x03);
-	LCDWriteData(0xCB);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-
-	LCDWriteRegister(0xE6);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x33);
-	LCDWriteData(0x33);
-
-	LCDWriteRegister(0xE7);
-	LCDWriteData(0x44);
-	LCDWriteData(0x44);
-
-	LCDWriteRegister(0xE8);
-	LCDWriteData(0x06);
-	LCDWriteData(0xCE);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x02);
-	LCDWriteData(0xCA);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x08);
-	LCDWriteData(0xD0);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x04);
-	LCDWriteData(0xCC);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-
-	LCDWriteRegister(0xEB);
-	LCDWriteData(0x08);
-	LCDWriteData(0x01);
-	LCDWriteData(0xE4);
-	LCDWriteData(0xE4);
-	LCDWriteData(0x88);
-	LCDWriteData(0x00);
-	LCDWriteData(0x40);
-
-	LCDWriteRegister(0xEC);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-
-	LCDWriteRegister(0xED);
-	LCDWriteData(0xFF);
-	LCDWriteData(0xF0);
-	LCDWriteData(0x07);
-	LCDWriteData(0x65);
-	LCDWriteData(0x4F);
-	LCDWriteData(0xFC);
-	LCDWriteData(0xC2);
-	LCDWriteData(0x2F);
-	LCDWriteData(0xF2);
-	LCDWriteData(0x2C);
-	LCDWriteData(0xCF);
-	LCDWriteData(0xF4);
-	LCDWriteData(0x56);
-	LCDWriteData(0x70);
-	LCDWriteData(0x0F);
-	LCDWriteData(0xFF);
-
-	LCDWriteRegister(0xEF);
-	LCDWriteData(0x10);
-	LCDWriteData(0x0D);
-	LCDWriteData(0x04);
-	LCDWriteData(0x08);
-	LCDWriteData(0x3F);
-	LCDWriteData(0x1F);
-
-	LCDWriteRegister(0xFF);
-	LCDWriteData(0x77);
-	LCDWriteData(0x01);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-
-	LCDWriteRegister(0x11);
-
-	HAL_Delay(120);
-
-	LCDWriteRegister(0x35);
-	LCDWriteData(0x00);
-
-	LCDWriteRegister(0x3A);
-	LCDWriteData(0x66);
-
-	//LCDWriteRegister(0x11);
-	//Delay(120);
-
-	LCDWriteRegister(0x29);
+	Trace_RestorePin(traced);
+}
+
+
+void AdaFruit_Init() {
+	LCD_RunInitTable(adafruit_init, sizeof(adafruit_init));
 }
 
 
 void BuyDisplay_Init() {
+	LCD_RunInitTable(buydisplay_init, sizeof(buydisplay_init));
+}
+
+
+// Porches for a live timing change. Only the BuyDisplay panel needs this: it runs in HV mode and takes
+// its porches from PORCTRL (its init table has 10/12, the VBPD/VFPD of the BuyD timing set). The AdaFruit
+// panel runs in DE mode, where the ST7701S follows the RGB timing from the LT7680 by itself.
+void LCD_SetPorch(uint8_t vbp, uint8_t vfp) {
+	static const uint8_t bank0[] = { 0x77, 0x01, 0x00, 0x00, 0x10 };
+	static const uint8_t bank_off[] = { 0x77, 0x01, 0x00, 0x00, 0x00 };
+	const uint8_t porch[] = { vbp, vfp };
+	uint8_t traced = Trace_ReleasePin();		// PB3 is LCD_CS while this runs
+
+	LCD_WriteCommand(0xFF, bank0, sizeof(bank0));
+	LCD_WriteCommand(0xC1, porch, sizeof(porch));
+	LCD_WriteCommand(0xFF, bank_off, sizeof(bank_off));
 
-	// Refer to ST7701S datasheet and your TFT LCD datasheet in order to make teh following settings
-
-	//*************************************************************************************************************************************
-	LCDWriteRegister(0xFF);			// CND2BKxSEL (FFh/FF00h): Command2 BK3 Selection - Command bank selection - Bank 3
-	LCDWriteData(0x77);
-	LCDWriteData(0x01);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x13);	// 10011b
-	
-	LCDWriteRegister(0xEF);			// not known
-	LCDWriteData(0x08);
-	
-	//*************************************************************************************************************************************
-	LCDWriteRegister(0xFF);			// CND2BKxSEL (FFh/FF00h): Command2 BK0 Selection - Command bank selection - Bank 0 (system)
-	LCDWriteData(0x77);
-	LCDWriteData(0x01);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x10);	// 10000b
-
-	LCDWriteRegister(0xC0);			// LNESET (C0h/C000h): Display Line Setting
-	LCDWriteData(0x77);				// 960 lines	77
-	LCDWriteData(0x00);				// 960 lines	00
-
-	LCDWriteRegister(0xC1);			// PORCTRL (C1h/C100h): Porch Control 
-	LCDWriteData(0x0A);				// VBP = 0A		(10 decimal)		VBPD
-	LCDWriteData(0x0C);				// VFP = 0C		(12 decimal)		VFPD
-
-	LCDWriteRegister(0xC2);			// INVSET (C2h/C200h): Inversion selection & Frame Rate Control 
-	LCDWriteData(0x37);				// C200h: Inversion Selection NLINV = 7								originally 37
-	LCDWriteData(0x08);				// C201h: Frame Rate Control RTNI =	8								originally = 0x02, tried 0x00
-
-	LCDWriteRegister(0xC3);			// RGBCTRL (C3h/C300h): RGB control
-	LCDWriteData(0x81);				// C300h: DE/HV=HV, VSP=L, HSP=L, DP=Rising, EP=High	=> 10000001										0x81						81
-	LCDWriteData(0x38);				// C301h: HBP_HVRGB[7:0] (Horizontal Back Porch in HSYNC in cycles)	originally 0x05 = 5					0x01	0x20 works		50	00
-	LCDWriteData(0x22);				// C302h: VBP_HVRGB[7:0] (Vertical Back Porch HSYNC in cycles)		originally 0x0D = 13				0x0D					0A	22
-
-	//LCDWriteRegister(0xC3); //????    
-	//LCDWriteData(0x02); //82 HVmode    02 DEmode 
-	
-	LCDWriteRegister(0xCC);			// not known
-	LCDWriteData(0x10);
-	
-	LCDWriteRegister(0xB0);			// PVGAMCTRL (B0h/B000h): Positive Voltage Gamma Control 
-	LCDWriteData(0x40);				// VC0P[3:0], AJ0P[1:0]
-	LCDWriteData(0x14);				// VC4P[5:0], AJ1P[1:0]
-	LCDWriteData(0x59);				// VC8P[5:0], AJ2P[1:0]
-	LCDWriteData(0x10);				// VC16P[4:0]
-	LCDWriteData(0x12);				// VC24P[4:0], AJ3P[1:0]
-	LCDWriteData(0x08);				// VC52P[3:0]
-	LCDWriteData(0x03);				// VC80P[5:0]
-	LCDWriteData(0x09);				// VC108P[3:0]
-	LCDWriteData(0x05);				// VC147P[3:0]
-	LCDWriteData(0x1E);				// VC175P[5:0]
-	LCDWriteData(0x05);				// VC203P[3:0]
-	LCDWriteData(0x14);				// VC231P[4:0], AJ4P[1:0]
-	LCDWriteData(0x10);				// VC239P[4:0]
-	LCDWriteData(0x68);				// VC247P[5:0], AJ5P[1:0]
-	LCDWriteData(0x33);				// VC251P[5:0], AJ6P[1:0]
-	LCDWriteData(0x15);				// VC255P[4:0], AJ7P[1:0]
-
-	LCDWriteRegister(0xB1);			// VCOMS (B1h/B100h):VCOM amplitude setting  
-	LCDWriteData(0x40);				// VC0N[3:0], AJ0N[1:0]
-	LCDWriteData(0x08);				// VC4N[5:0], AJ1N[1:0]
-	LCDWriteData(0x53);				// VC8N[5:0], AJ2N[1:0]
-	LCDWriteData(0x09);				// VC16N[4:0]
-	LCDWriteData(0x11);				// VC24N[4:0], AJ3N[1:0]
-	LCDWriteData(0x09);				// VC52N[3:0]
-	LCDWriteData(0x02);				// VC80N[5:0]
-	LCDWriteData(0x07);				// VC108N[3:0]
-	LCDWriteData(0x09);				// VC147N[3:0]
-	LCDWriteData(0x1A);				// VC175N[5:0]
-	LCDWriteData(0x04);				// VC203N[3:0]
-	LCDWriteData(0x12);				// VC231N[4:0], AJ4N[1:0]
-	LCDWriteData(0x12);				// VC239N[4:0]
-	LCDWriteData(0x64);				// VC247N[5:0], AJ5N[1:0]
-	LCDWriteData(0x29);				// VC251N[5:0], AJ6N[1:0]
-	LCDWriteData(0x29);				// VC255N[4:0], AJ7N[1:0]
-
-	//*************************************************************************************************************************************
-	LCDWriteRegister(0xFF);			// CND2BKxSEL (FFh/FF00h): Command2 BK1 Selection - Command bank selection - Bank 1
-	LCDWriteData(0x77);
-	LCDWriteData(0x01);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x11);	//10001b
-
-	LCDWriteRegister(0xB0);			// BK1: VRHS (B0h/B000h): Vop Amplitude setting 
-	LCDWriteData(0x6D);				// VRHA[7:0] = 0x6D (109 in decimal) - 4.9Vdc
-
-	LCDWriteRegister(0xB1);			// VCOMS (B1h/B100h): VCOM amplitude setting 
-	LCDWriteData(0x1D);
-
-	LCDWriteRegister(0xB2);			// VGHSS (B2h/B200h): VGH Voltage setting  
-	LCDWriteData(0x87);
-
-	LCDWriteRegister(0xB3);			// TESTCMD (B3h/B300h): Internal TEST Command Setting  
-	LCDWriteData(0x00);				// 0x80 = enable test (if LCD has routine), 0x00 = disable										originally 0x80 = enabled
-
-	LCDWriteRegister(0xB5);			// VGLS (B5h/B500h): VGL Voltage setting  
-	LCDWriteData(0x49);
-
-	LCDWriteRegister(0xB7);			// PWCTRL1 (B7h/B700h): Power Control 1  
-	LCDWriteData(0x85);
-
-	LCDWriteRegister(0xB8);			// PWCTRL2 (B8h/B800h): Power Control 2 
-	LCDWriteData(0x20);
-
-	LCDWriteRegister(0xC1);			// SPD1 (C1h/C100h): Source pre_drive timing set1  
-	LCDWriteData(0x78);
-
-	LCDWriteRegister(0xC2);			// SPD2 (C2h/C200h): Source EQ2 Setting  
-	LCDWriteData(0x78);
-
-	LCDWriteRegister(0xD0);			// MIPISET1 (D0h/D000h): MIPI Setting 1  - Ignore if LCD is using parallel or SPI comms
-	LCDWriteData(0x88);
-
-	LCDWriteRegister(0xE0);			// SECTRL (E0h/E000h): Sunlight Readable Enhancement  
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x02);
-
-	// NRCTRL (E1h/E100h): Noise Reduce Control
-	uint8_t enablenr = 0;  // 1 to enable, 0 to disable noise reduction
-	uint8_t levelnr = 0x02; // Noise reduction level (0b00, 0b01, 0b10, 0b11)
-	uint8_t byte1nr = (enablenr ? (1 << 4) : 0x00) | (levelnr & 0x03);
-	LCDWriteRegister(0xE1);
-	LCDWriteData(byte1nr); // Byte 1: Enable/Disable and Level Adjust
-	LCDWriteData(0x8C);  // Byte 2: Reserved/unknown
-	LCDWriteData(0x00);  // Byte 3: Reserved/unknown
-	LCDWriteData(0x00);  // Byte 4: Reserved/unknown
-	LCDWriteData(0x03);  // Byte 5: Reserved/unknown
-	LCDWriteData(0x8C);  // Byte 6: Reserved/unknown
-	LCDWriteData(0x00);  // Byte 7: Reserved/unknown
-	LCDWriteData(0x00);  // Byte 8: Reserved/unknown
-	LCDWriteData(0x00);  // Byte 9: Reserved/unknown
-	LCDWriteData(0x33);  // Byte 10: Reserved/unknown
-	LCDWriteData(0x33);  // Byte 11: Reserved/unknown
-
-	// SECTRL (E2h/E200h): Sharpness Control  
-	uint8_t enablesc = 0;  // 1 to enable sharpness, 0 to disable
-	uint8_t levelsc = 0x02; // Sharpness level (0b00, 0b01, 0b10, 0b11)
-	// Construct Byte 1: Enable/Disable and Level Adjust
-	uint8_t byte1sc = (enablesc ? (1 << 4) : 0x00) | (levelsc & 0x03);
-	LCDWriteRegister(0xE2);
-	LCDWriteData(byte1sc); // Byte 1: Enable/Disable and Level Adjust
-	LCDWriteData(0x33);  // Byte 2: Reserved/unknown
-	LCDWriteData(0x33);  // Byte 3: Reserved/unknown
-	LCDWriteData(0x33);  // Byte 4: Reserved/unknown
-	LCDWriteData(0x33);  // Byte 5: Reserved/unknown
-	LCDWriteData(0xC9);  // Byte 6: Reserved/unknown
-	LCDWriteData(0x3C);  // Byte 7: Reserved/unknown
-	LCDWriteData(0x00);  // Byte 8: Reserved/unknown
-	LCDWriteData(0x00);  // Byte 9: Reserved/unknown
-	LCDWriteData(0xCA);  // Byte 10: Reserved/unknown
-	LCDWriteData(0x3C);  // Byte 11: Reserved/unknown
-	LCDWriteData(0x00);  // Byte 12: Reserved/unknown
-	LCDWriteData(0x00);  // Byte 13: Reserved/unknown
-	LCDWriteData(0x00);  // Byte 14: Reserved/unknown
-
-	LCDWriteRegister(0xE3);			// CCCTRL (E3h/E300h): Color Calibration Control 
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x33);
-	LCDWriteData(0x33);
-
-	LCDWriteRegister(0xE4);			// SKCTRL (E4h/E400h): Skin Tone Preservation Control 
-	LCDWriteData(0x44);
-	LCDWriteData(0x44);
-	
-	LCDWriteRegister(0xE5);			// not known
-	LCDWriteData(0x05);
-	LCDWriteData(0xCD);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x01);
-	LCDWriteData(0xC9);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x07);
-	LCDWriteData(0xCF);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x03);
-	LCDWriteData(0xCB);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	
-	LCDWriteRegister(0xE6);			// not known
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x33);
-	LCDWriteData(0x33);
-
-	LCDWriteRegister(0xE7);			// not known
-	LCDWriteData(0x44);
-	LCDWriteData(0x44);
-
-	LCDWriteRegister(0xE8);			// not known
-	LCDWriteData(0x06);
-	LCDWriteData(0xCE);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x02);
-	LCDWriteData(0xCA);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x08);
-	LCDWriteData(0xD0);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-	LCDWriteData(0x04);
-	LCDWriteData(0xCC);
-	LCDWriteData(0x82);
-	LCDWriteData(0x82);
-
-	LCDWriteRegister(0xEB);			// not known
-	LCDWriteData(0x08);
-	LCDWriteData(0x01);
-	LCDWriteData(0xE4);
-	LCDWriteData(0xE4);
-	LCDWriteData(0x88);
-	LCDWriteData(0x00);
-	LCDWriteData(0x40);
-
-	LCDWriteRegister(0xEC);			// not known
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-
-	LCDWriteRegister(0xED);			// not known
-	LCDWriteData(0xFF);
-	LCDWriteData(0xF0);
-	LCDWriteData(0x07);
-	LCDWriteData(0x65);
-	LCDWriteData(0x4F);
-	LCDWriteData(0xFC);
-	LCDWriteData(0xC2);
-	LCDWriteData(0x2F);
-	LCDWriteData(0xF2);
-	LCDWriteData(0x2C);
-	LCDWriteData(0xCF);
-	LCDWriteData(0xF4);
-	LCDWriteData(0x56);
-	LCDWriteData(0x70);
-	LCDWriteData(0x0F);
-	LCDWriteData(0xFF);
-
-	LCDWriteRegister(0xEF);			// not known
-	LCDWriteData(0x10);
-	LCDWriteData(0x0D);
-	LCDWriteData(0x04);
-	LCDWriteData(0x08);
-	LCDWriteData(0x3F);
-	LCDWriteData(0x1F);
-	
-	//*************************************************************************************************************************************
-	LCDWriteRegister(0xFF);			// CND2BKxSEL (FFh/FF00h): Command2 BKx Selection - Command bank selection - Disable Banl function
-	LCDWriteData(0x77);
-	LCDWriteData(0x01);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);
-	LCDWriteData(0x00);	//00000b
-
-	LCDWriteRegister(0x11);			// SLPOUT (11h/1100h): Sleep Out  
-	HAL_Delay(120);
-
-	//LCDWriteRegister(0x34);			// TEON (35h/3500h): Tearing Effect Line OFF
-	//LCDWriteData(0x00);
-
-	LCDWriteRegister(0x35);			// TEON (35h/3500h): Tearing Effect Line ON  
-	LCDWriteData(0x00);
-
-	LCDWriteRegister(0x3A);			// COLMOD (3Ah/3A00h): Interface Pixel Format  
-	LCDWriteData(0x55);				// 16bpp for compatibility with LT7680A-R
-	//LCDWriteData(0x66);				// 18bpp
-	
-	LCDWriteRegister(0x29); 		// DISPON (29h/2900h): Display On 
+	Trace_RestorePin(traced);
 }
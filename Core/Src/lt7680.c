@@ -30,6 +30,8 @@
 
 #include "lt7680.h"
 #include "main.h"
+#include "boot.h"
+#include "trace.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -37,17 +39,73 @@
 // SPI handle (ensure this matches actual SPI instance)
 extern SPI_HandleTypeDef hspi1;
 
+static void PLL_Registers_LT(uint8_t regs[6]);
+static void TimingImage_LT(uint8_t image[]);
+
+// Registers that follow the timing settings, in the order TimingImage_LT() fills them. The PLL comes first.
+#define TIMING_PLL_REGS     6
+#define TIMING_REGS         (sizeof(timing_regs) / sizeof(timing_regs[0]))
+static const uint8_t timing_regs[] = { 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x16, 0x18, 0x19, 0x1C, 0x1E, 0x1F };
+
+// What those registers were last set to, 0 = unknown
+static uint8_t timing_image[TIMING_REGS];
+static uint8_t timing_image_valid = 0;
+
+volatile uint32_t lt7680_retune_writes = 0;     // Registers written by the last LT7680_Retune()
+
+// PLL registers precomputed for the current timings (see timings.c), NULL = work them out
+static const uint8_t* pll_preset = NULL;
+
 char LT7680StatusMessages[8][50]; // 8 messages, each up to 50 characters long
 volatile uint8_t system_ok = 0;
 volatile uint8_t LT7680_SPI_Read_ok = 0;
+volatile uint32_t lt7680_bus_bytes = 0;        // SPI1 bytes sent and received, free running
 volatile uint8_t System_Check = 0;
 volatile uint8_t SystemCheckTempValue = 0;
 
-void HardwareReset(void) {
+// Reset pulse, then wait for the LT7680 to leave the inhibit state rather than a fixed 100 ms + 1 s.
+// Returns 0 if it did not come ready in time, the old fixed delay has been used instead.
+uint8_t HardwareReset(void) {
     HAL_GPIO_WritePin(RESET_PORT, RESET_PIN, GPIO_PIN_RESET); // Pull reset low
-    HAL_Delay(100); // Delay 100 ms
+    HAL_Delay(1);   // Datasheet minimum is a few us
     HAL_GPIO_WritePin(RESET_PORT, RESET_PIN, GPIO_PIN_SET);   // Release reset
-    HAL_Delay(100); // Delay 100 ms
+
+    return WaitStatus(STSR_IDLE_MASK, STSR_IDLE, LT7680_RESET_TIMEOUT_MS, 1100);
+}
+
+
+// Poll STSR until (status & mask) == value. Gives up after timeoutMs and then waits fallbackMs,
+// the fixed delay the boot sequence used before, so a slow part still gets set up.
+// Returns 1 = ready, 0 = timed out.
+uint8_t WaitStatus(uint8_t mask, uint8_t value, uint32_t timeoutMs, uint32_t fallbackMs) {
+    uint32_t start = HAL_GetTick();
+
+    do {
+        if ((ReadStatus() & mask) == value && LT7680_SPI_Read_ok) {
+            return 1;
+        }
+    } while ((HAL_GetTick() - start) <= timeoutMs);
+
+    Trace_Event(TRACE_TIMEOUT, 0x100);
+    HAL_Delay(fallbackMs);
+    return 0;
+}
+
+
+// As WaitStatus, for a bit in a register
+uint8_t WaitRegister(uint8_t reg, uint8_t mask, uint8_t value, uint32_t timeoutMs, uint32_t fallbackMs) {
+    uint32_t start = HAL_GetTick();
+
+    do {
+        WriteRegister(reg);
+        if ((ReadData() & mask) == value) {
+            return 1;
+        }
+    } while ((HAL_GetTick() - start) <= timeoutMs);
+
+    Trace_Event(TRACE_TIMEOUT, reg);
+    HAL_Delay(fallbackMs);
+    return 0;
 }
 
 
@@ -61,6 +119,7 @@ void WriteRegister(uint8_t reg) {
     HAL_SPI_Transmit(&hspi1, &controlByte, 1, HAL_MAX_DELAY);                 // Send control byte
     HAL_SPI_Transmit(&hspi1, &reg, 1, HAL_MAX_DELAY);                         // Send register address
     HAL_GPIO_WritePin(SPI_CS_PORT, SPI_CS_PIN, GPIO_PIN_SET);   // CS High
+    lt7680_bus_bytes += 2;
 }
 
 // Write Data
@@ -70,6 +129,7 @@ void WriteData(uint8_t data) {
     HAL_SPI_Transmit(&hspi1, &controlByte, 1, HAL_MAX_DELAY);                 // Send control byte
     HAL_SPI_Transmit(&hspi1, &data, 1, HAL_MAX_DELAY);                        // Send data byte
     HAL_GPIO_WritePin(SPI_CS_PORT, SPI_CS_PIN, GPIO_PIN_SET);   // CS High
+    lt7680_bus_bytes += 2;
 }
 
 // Read Status Register
@@ -88,6 +148,7 @@ uint8_t ReadStatus(void) {
     }
 
     HAL_GPIO_WritePin(SPI_CS_PORT, SPI_CS_PIN, GPIO_PIN_SET);   // CS High
+    lt7680_bus_bytes += 2;
     return status;
 }
 
@@ -99,9 +160,16 @@ uint8_t ReadData(void) {
     HAL_SPI_Transmit(&hspi1, &controlByte, 1, HAL_MAX_DELAY);                 // Send control byte
     HAL_SPI_Receive(&hspi1, &data, 1, HAL_MAX_DELAY);                         // Read data byte
     HAL_GPIO_WritePin(SPI_CS_PORT, SPI_CS_PIN, GPIO_PIN_SET);   // CS High
+    lt7680_bus_bytes += 2;
     return data;
 }
 
+// Read a register
+uint8_t ReadRegister(uint8_t reg) {
+    WriteRegister(reg);
+    return ReadData();
+}
+
 // Write Register Address and Data (combined) - optional
 void WriteDataToRegister(uint8_t reg, uint8_t value) {
     WriteRegister(reg); // Write the register address
@@ -112,68 +180,148 @@ void WriteDataToRegister(uint8_t reg, uint8_t value) {
 //**************************************************************************************************
 // Subs to run and send to the LT7680
 
+// Each step is polled for readiness with a bounded timeout rather than a fixed delay, register writes
+// need no delay at all as WriteData() only returns once SPI1 has sent the byte. Times go to the boot log.
 void SendAllToLT7680_LT() {
   
     Software_Reset_LT();
-    HAL_Delay(10);
-    LT7680_PLL_Initial_LT();                  // Initialize PLL first for stable clocks
-    HAL_Delay(100);
-    SDRAM_Init_LT();                          // Initialize SDRAM after the reset
-    HAL_Delay(5);
+    Boot_Step("LT7680 sw reset", WaitStatus(STSR_IDLE_MASK, STSR_IDLE, LT7680_RESET_TIMEOUT_MS, 10));
+    Boot_Step("LT7680 PLL", LT7680_PLL_Initial_LT());   // Initialize PLL first for stable clocks
+    Boot_Step("LT7680 SDRAM", SDRAM_Init_LT());         // Initialize SDRAM after the reset
 
     Set_LCD_Panel_LT();                       // Set up the panel interface
-    HAL_Delay(100);
 
     //WriteRegister(0x84);                      // Set backlighting Prescaler to zero which effectively turns off backlighting
     //WriteData(0x00); // Prescaler = 00
-    //HAL_Delay(5);
 
     LCDConfigTurnOn_LT();
-    HAL_Delay(5);
 
     LCD_HorizontalWidth_VerticalHeight_LT(LCD_XSIZE_TFT, LCD_YSIZE_TFT);
-    HAL_Delay(5);
     LCD_Horizontal_Non_Display_LT(LCD_HBPD);  // Horizontal Back Porch
-    HAL_Delay(5);
     LCD_HSYNC_Start_Position_LT(LCD_HFPD);    // HSYNC Start Position
-    HAL_Delay(5);
     LCD_HSYNC_Pulse_Width_LT(LCD_HSPW);       // HSYNC Pulse Width
-    HAL_Delay(5);
     LCD_Vertical_Non_Display_LT(LCD_VBPD);    // Vertical Back Porch
-    HAL_Delay(5);
     LCD_VSYNC_Start_Position_LT(LCD_VFPD);    // VSYNC Start Position
-    HAL_Delay(5);
     LCD_VSYNC_Pulse_Width_LT(LCD_VSPW);       // VSYNC Pulse Width
-    HAL_Delay(5);
     SetColorDepth_LT();                       // Configure canvas color depth
-    HAL_Delay(5);
     Configure_Main_PIP_Window_LT();
-    HAL_Delay(5);
     SetMainImageWidth_LT();
-    HAL_Delay(5);
     SetMainWindowUpperLeftX_LT();
-    HAL_Delay(5);
     ConfigureActiveDisplayArea_LT();
-    HAL_Delay(5);
     SetActiveWindow_LT();                     // Set active window dimensions
-    HAL_Delay(5);
     SetCanvasStartAddress_LT();
-    HAL_Delay(5);
     SetCanvasImageWidth_LT();
-    HAL_Delay(5);
     ResetGraphicWritePosition_LT();
-    HAL_Delay(5);
     SetGraphicRWYCoordinate_LT();
-    HAL_Delay(5);
     Set_MISA_LT();                            // Configure the Main Image Start Address
-    HAL_Delay(5);
    
     Text_Mode();
-    ClearScreen();                            // Draws black 'spaces' across the whole screen - fast
+    Boot_Step("LT7680 panel", 1);
+
+    TimingImage_LT(timing_image);
+    timing_image_valid = 1;
+
+    Boot_Step("Clear screen", ClearScreenFast());   // One geometric engine fill instead of 3000 black 'spaces'
     
 }
 
 
+// Warm restart probe - 1 = the LT7680 is still set up exactly as SendAllToLT7680_LT() would leave it
+// with the current settings: out of reset, SDRAM ready, running on the PLL with the expected PLL and
+// panel timing registers, display on, and the PIP-1 window signature (reset value 0) in place.
+uint8_t LT7680_ConfigMatches(void) {
+    static const uint8_t signature[][2] = {
+        { 0x2E, 100 & 0xFC },   // PIP window lower-right X, see Configure_Main_PIP_Window_LT
+        { 0x30, 100 & 0xFF },   // PIP window lower-right Y
+    };
+    uint8_t image[TIMING_REGS];
+
+    if ((ReadStatus() & (STSR_IDLE_MASK | STSR_SDRAM_READY)) != (STSR_IDLE | STSR_SDRAM_READY) || !LT7680_SPI_Read_ok) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < sizeof(signature) / sizeof(signature[0]); i++) {
+        if (ReadRegister(signature[i][0]) != signature[i][1]) {
+            return 0;
+        }
+    }
+
+    if ((ReadRegister(0x00) & 0x80) == 0 || (ReadRegister(0x12) & (1 << 6)) == 0) {
+        return 0;                               // Not on the PLL clocks, or display off
+    }
+
+    // PLL and panel timing, as written by LT7680_PLL_Initial_LT() and the LCD_..._LT() setters
+    TimingImage_LT(image);
+    for (uint8_t i = 0; i < TIMING_REGS; i++) {
+        if (ReadRegister(timing_regs[i]) != image[i]) {
+            return 0;
+        }
+    }
+
+    // Fixed panel size
+    const uint8_t size[][2] = {
+        { 0x14, LCD_XSIZE_TFT / 8 - 1 },
+        { 0x1A, (LCD_YSIZE_TFT - 1) & 0xFF },
+        { 0x1B, (LCD_YSIZE_TFT - 1) >> 8 },
+    };
+    for (uint8_t i = 0; i < sizeof(size) / sizeof(size[0]); i++) {
+        if (ReadRegister(size[i][0]) != size[i][1]) {
+            return 0;
+        }
+    }
+
+    memcpy(timing_image, image, sizeof(timing_image));
+    timing_image_valid = 1;
+    return 1;
+}
+
+
+// Apply changed timing settings (LCD_HBPD etc.) to a running LT7680. Only the registers whose value
+// differs from what was last written are sent, the PLL is only switched over again if one of its
+// registers changed. Returns 0 if the PLL did not lock in time.
+uint8_t LT7680_Retune(void) {
+    uint8_t image[TIMING_REGS];
+    uint8_t pll_changed = 0;
+    uint8_t ok = 1;
+
+    TimingImage_LT(image);
+    lt7680_retune_writes = 0;
+
+    for (uint8_t i = 0; i < TIMING_REGS; i++) {
+        if (!timing_image_valid || image[i] != timing_image[i]) {
+            WriteRegister(timing_regs[i]);
+            WriteData(image[i]);
+            lt7680_retune_writes++;
+            if (i < TIMING_PLL_REGS) {
+                pll_changed = 1;
+            }
+        }
+    }
+
+    if (pll_changed) {
+        WriteRegister(0x00);
+        WriteData(0x80);
+        ok = WaitRegister(0x00, 0x80, 0x80, LT7680_PLL_TIMEOUT_MS, 10);
+    }
+
+    memcpy(timing_image, image, sizeof(timing_image));
+    timing_image_valid = 1;
+    return ok;
+}
+
+
+// Expected contents of timing_regs[] for the current settings
+static void TimingImage_LT(uint8_t image[]) {
+    PLL_Registers_LT(image);
+    image[6] = (uint8_t)(LCD_HBPD / 8 - 1);
+    image[7] = LCD_HFPD < 8 ? 0 : (uint8_t)(LCD_HFPD / 8 - 1);
+    image[8] = LCD_HSPW < 8 ? 0 : (uint8_t)(LCD_HSPW / 8 - 1);
+    image[9] = (uint8_t)(LCD_VBPD - 1);
+    image[10] = (uint8_t)(LCD_VFPD - 1);
+    image[11] = (uint8_t)(LCD_VSPW - 1);
+}
+
+
 //******************************************************************************
 // ROUTINES
 
@@ -606,12 +754,50 @@ void FillScreen(uint32_t color) {
 }
 
 
+// Filled rectangle with the geometric drawing engine, same coordinates and colour registers as DrawLine.
+// Returns 0 if the engine was still busy when the timeout ran out.
+uint8_t FillRectangle(uint16_t startX, uint16_t startY, uint16_t endX, uint16_t endY, uint16_t colorRED, uint16_t colorGREEN, uint16_t colorBLUE) {
+    WriteRegister(0x68); WriteData(startX & 0xFF);          // DLHSR
+    WriteRegister(0x69); WriteData((startX >> 8) & 0x1F);
+    WriteRegister(0x6A); WriteData(startY & 0xFF);          // DLVSR
+    WriteRegister(0x6B); WriteData((startY >> 8) & 0x1F);
+    WriteRegister(0x6C); WriteData(endX & 0xFF);            // DLHER
+    WriteRegister(0x6D); WriteData((endX >> 8) & 0x1F);
+    WriteRegister(0x6E); WriteData(endY & 0xFF);            // DLVER
+    WriteRegister(0x6F); WriteData((endY >> 8) & 0x1F);
+
+    WriteRegister(0xD2); WriteData(colorRED);               // Foreground colour
+    WriteRegister(0xD3); WriteData(colorGREEN);
+    WriteRegister(0xD4); WriteData(colorBLUE);
+
+    WriteRegister(0x76);    // Draw Circle/Ellipse/Rectangle Control Register
+    WriteData(0xE0);        // Start drawing (bit 7), filled (bit 6), rectangle (bits 5-4 = 10)
+
+    return WaitStatus(STSR_CORE_BUSY, 0, LT7680_FILL_TIMEOUT_MS, 0);
+}
+
+
+// Clear the whole canvas, including the hidden 80 pixel overscan strip, to black
+uint8_t ClearScreenFast(void) {
+    return FillRectangle(0, 0, LCD_XSIZE_TFT - 1, LCD_YSIZE_TFT - 1, 0x00, 0x00, 0x00);
+}
+
+
 //**************************************************************************************************
 // Subs to run and sent to the LT7680 - Translated from Levetop sample info
 
-// Register 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x00
-void LT7680_PLL_Initial_LT() {
-    // Parameters
+// Values for registers 0x05 to 0x0A for the current panel timings
+// Use precomputed PLL registers for the current timings from now on, NULL = work them out from LCD_HBPD etc.
+void LT7680_SetPLL(const uint8_t regs[6]) {
+    pll_preset = regs;
+}
+
+
+static void PLL_Registers_LT(uint8_t regs[6]) {
+    if (pll_preset != NULL) {
+        memcpy(regs, pll_preset, 6);
+        return;
+    }
 
     // Clock calculations
     unsigned int temp = (LCD_HBPD + LCD_HFPD + LCD_HSPW + LCD_XSIZE_TFT) *
@@ -633,33 +819,36 @@ void LT7680_PLL_Initial_LT() {
     unsigned short lpllR_sclk = 5, lpllR_cclk = 5, lpllR_mclk = 5;
     unsigned short lpllN_sclk = SCLK, lpllN_cclk = CCLK, lpllN_mclk = MCLK;
 
-    // Configure PCLK PLL - TFT pixel clock (max=80MHz) (Registers 0x05 and 0x06)
-    WriteRegister(0x05);
-    WriteData((lpllOD_sclk << 6) | (lpllR_sclk << 1) | ((lpllN_sclk >> 8) & 0x1));      // 8A
-    
-    WriteRegister(0x06);
-    WriteData(lpllN_sclk & 0xFF);                                                       // 1B
+    // PCLK PLL - TFT pixel clock (max=80MHz) (Registers 0x05 and 0x06)
+    regs[0] = (lpllOD_sclk << 6) | (lpllR_sclk << 1) | ((lpllN_sclk >> 8) & 0x1);      // 8A
+    regs[1] = lpllN_sclk & 0xFF;                                                       // 1B
 
-    // Configure MCLK PLL - Display memory clock (max=133MHz) (Registers 0x07 and 0x08)
-    WriteRegister(0x07);
-    WriteData((lpllOD_mclk << 6) | (lpllR_mclk << 1) | ((lpllN_mclk >> 8) & 0x1));      // 8A
-    
-    WriteRegister(0x08);                // 36
-    WriteData(lpllN_mclk & 0xFF);                                                       // 36
+    // MCLK PLL - Display memory clock (max=133MHz) (Registers 0x07 and 0x08)
+    regs[2] = (lpllOD_mclk << 6) | (lpllR_mclk << 1) | ((lpllN_mclk >> 8) & 0x1);      // 8A
+    regs[3] = lpllN_mclk & 0xFF;                                                       // 36
 
-    // Configure CCLK PLL - Core clock (max=100MHz) (Registers 0x09 and 0x0A)
-    WriteRegister(0x09);
-    WriteData((lpllOD_cclk << 6) | (lpllR_cclk << 1) | ((lpllN_cclk >> 8) & 0x1));      // 8A
-    
-    WriteRegister(0x0A);
-    WriteData(lpllN_cclk & 0xFF);                                                       // 36
+    // CCLK PLL - Core clock (max=100MHz) (Registers 0x09 and 0x0A)
+    regs[4] = (lpllOD_cclk << 6) | (lpllR_cclk << 1) | ((lpllN_cclk >> 8) & 0x1);      // 8A
+    regs[5] = lpllN_cclk & 0xFF;                                                       // 36
+}
+
+
+// Register 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x00
+uint8_t LT7680_PLL_Initial_LT() {
+    uint8_t regs[6];
+
+    PLL_Registers_LT(regs);
+    for (uint8_t i = 0; i < 6; i++) {
+        WriteRegister(0x05 + i);
+        WriteData(regs[i]);
+    }
 
     // Trigger PLL reconfiguration (Register 0x00)
     WriteRegister(0x00);
     WriteData(0x80);
 
-    // Add delay to allow PLL settings to stabilize
-    HAL_Delay(10); // delay
+    // Bit 7 reads back as 1 once the LT7680 has switched over to the PLL clocks
+    return WaitRegister(0x00, 0x80, 0x80, LT7680_PLL_TIMEOUT_MS, 10);
 }
 
 
@@ -708,7 +897,7 @@ void Configure_Main_PIP_Window_LT() {
 
 
 // Register 0xE0, 0xE1, 0xE2, 0xE3, 0xE4
-void SDRAM_Init_LT() {
+uint8_t SDRAM_Init_LT() {
 
     unsigned short sdram_itv;
     uint8_t regValue1 = 0;
@@ -751,26 +940,18 @@ void SDRAM_Init_LT() {
     //regValue1 |= (0 << 2);
     WriteData(regValue1);
 
-    HAL_Delay(1); // 1 ms delay
-
-    Check_SDRAM_Ready_LT();     // Call sub to wait for SDRAM initialization to complete
+    return Check_SDRAM_Ready_LT();     // Call sub to wait for SDRAM initialization to complete
 
 }
 
 
 // Check if the SDRAM is ready for use - Address = 0xE4
-void Check_SDRAM_Ready_LT() {
-    
-    unsigned char status;
-    
-    // Poll the SDRAM Ready Flag (Bit 0) in Register 0xE4
-    do {
-        WriteRegister(0xE4);
-        status = ReadData(); // Read the SDRAM status register
-    } while ((status & 0x01) == 0);  // Wait until the Ready bit (bit 0) is set
+// Returns 0 if it timed out, the old 11 ms of fixed delay has been used instead.
+uint8_t Check_SDRAM_Ready_LT() {
     
-    // Optional delay to ensure SDRAM is stable after initialization
-    HAL_Delay(10);  // 10 ms delay
+    // Poll the SDRAM Ready Flag (Bit 0) in Register 0xE4, then the SDRAM ready bit in STSR
+    return WaitRegister(0xE4, 0x01, 0x01, LT7680_SDRAM_TIMEOUT_MS, 11)
+        && WaitStatus(STSR_SDRAM_READY, STSR_SDRAM_READY, LT7680_SDRAM_TIMEOUT_MS, 0);
 
 }
 
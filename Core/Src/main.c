@@ -28,79 +28,50 @@
 #include <string.h>
 #include <stdint.h>
 #include "lt7680.h"
+#include "lcd.h"
 #include "timer.h"
 #include <stdbool.h>		// bool support, otherwise use _Bool
 #include "display.h"
+#include "capture.h"
+#include "decode.h"
+#include "filter.h"
+#include "glyphlog.h"
+#include "debug.h"
+#include "boot.h"
+#include "speedtest.h"
+#include "settings.h"
+#include "timings.h"
+#include "profile.h"
+#include "latency.h"
+#include "trace.h"
 #include "stm32f1xx_hal.h"
 #include <stdlib.h>			// required for float (soft FPU)
 
 /* Variables ---------------------------------------------------------*/
-static char main_display_debug[LINE1_LEN + 1]; // Main display debug string
-#define FONT_HEIGHT 7
 uint16_t dollarPosition = 0;
 
-// EEProm emulation (Flash)
-#define EEPROM_START_ADDRESS 0x0800FC00 // Last page for 64KB Flash
-#define EEPROM_PAGE_SIZE     1024       // Page size in bytes
+// BASEPRI value that holds off PendSV (deferred decode) and nothing else
+#define DECODE_MASK          (IRQ_PRIO_BACKGROUND << (8U - __NVIC_PRIO_BITS))
+
+// Timing adjust: save the chosen set to flash after this long without a press
+#define TIMING_SAVE_IDLE_MS  3000
 
 // TFT timing vars
 _Bool timingModsOnBoot = false;
 _Bool timingModsOnBootDCV = false;
 _Bool timingModspreviousstate = false;
-uint8_t currentTimingSet = 0;		// Variable to track the current timing set (0 to 5)
+uint8_t currentTimingSet = 0;		// Variable to track the current timing set, index into the profiles in timings.c
 static bool isFirstPress = true; // Tracks whether this is the first press
-const uint32_t LCD_VBPD_SETTINGS[6]         = { 17, 17, 17, 17, 17, 10 };		// Define the timing settings for each mode
-const uint32_t LCD_VFPD_SETTINGS[6]         = { 14, 14, 14, 15, 15, 12 };
-const uint32_t LCD_VSPW_SETTINGS[6]         = { 2,  3,  4,  2,  2,  3 };
-const uint32_t LCD_HBPD_SETTINGS[6]         = { 50, 50, 50, 50, 50, 80 };
-const uint32_t LCD_HFPD_SETTINGS[6]         = { 30, 30, 30, 30, 30, 30 };
-const uint32_t LCD_HSPW_SETTINGS[6]         = { 10, 10, 10, 10, 10, 20 };
-const uint32_t REFRESH_RATE_SETTINGS[6]     = { 60, 60, 60, 60, 45, 60 };
-const char ADA_BUY_SETTINGS[6][5]           = {"AdaF", "AdaF", "AdaF", "AdaF", "AdaF", "BuyD"};		// 4 characters plus the null terminator('\0').
-uint8_t currentTimingSetNumberentries = 6;	// number of entries	
-uint32_t LCD_VBPD = 17;		// default
-uint32_t LCD_VFPD = 14;
-uint32_t LCD_VSPW = 2;
-uint32_t LCD_HBPD = 50;
-uint32_t LCD_HFPD = 30;
-uint32_t LCD_HSPW = 10;
-uint32_t REFRESH_RATE = 60;
-char ADA_BUY[5] = "AdaF";
-
-// Buffers for each LCD graphical item
-char LCD_buffer_packets[128];  // For packet data
-char LCD_buffer_bitmaps[128];  // For decoded bitmap data
-char LCD_buffer_chars[128];    // For decoded characters
-
-char G[64];  // MAIN: G1 to G18, AUX: G19 to G47, extra guard space
-_Bool Annunc[19]; // Annunciators re-ordered, 18off, G1 to G18 in left-to-right order
-_Bool AnnuncTemp[37]; // Temp array for annunciators. 18off, the order on LCD left to right = 8,7,6,5,4,3,2,1,18,17,16,15,14,13,12,11,10,9
-
-// Global variable to store the unmatched bitmap
-uint8_t unmatchedBitmap[FONT_HEIGHT] = { 0 }; // Initialize to zero
-
-// SPI receive buffer for packets data
-volatile uint8_t rx_buffer[PACKET_WIDTH * PACKET_COUNT];
-
-// Array with character bitmaps
-uint8_t chars[CHAR_COUNT][CHAR_HEIGHT];
-
-// Array with annunciators flags (boolean)
-uint8_t flags[CHAR_COUNT];
-
-// When scanning the display, the order of the characters output is not sequential due to optimization of the VFD PCB layout.
-// The Reorder[] array is used as a lookup table to determine the correct position of characters.
-const uint8_t Reorder[PACKET_COUNT] = { 8, 7, 6, 5, 4, 3, 2, 1, 0, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 17, 16, 15, 14, 13, 12, 11, 10, 9, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36 };
-// Order of data to the display (effectively into the shift registers):
-// 8, 7, 6, 5, 4, 3, 2, 1, 0,                                               // MAIN: G9 to G1
-// 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35,  // AUX: G19 to G36
-// 17, 16, 15, 14, 13, 12, 11, 10, 9,                                       // MAIN: G18 to G10
-// 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36                               // AUX: G47 to G37
-// But the actual display left to right:
-// G1 to G18 - MAIN
-// G19 to G47 - AUX
-// Annunc[1] to Annunc[18]
-// Annunciators = SMPL IDLE AUTO LOP NULL DFILT MATH AZERO ERR INFO FRONT REAR SLOT LO_G RMT TLK LTN SRQ
+static bool timingSavePending = false;	// A new timing set has been applied but not saved yet
+static uint32_t timingChangedTick = 0;
+uint32_t LCD_VBPD = SETTINGS_DEFAULT_VBPD;		// default
+uint32_t LCD_VFPD = SETTINGS_DEFAULT_VFPD;
+uint32_t LCD_VSPW = SETTINGS_DEFAULT_VSPW;
+uint32_t LCD_HBPD = SETTINGS_DEFAULT_HBPD;
+uint32_t LCD_HFPD = SETTINGS_DEFAULT_HFPD;
+uint32_t LCD_HSPW = SETTINGS_DEFAULT_HSPW;
+uint32_t REFRESH_RATE = SETTINGS_DEFAULT_REFRESH;
+char ADA_BUY[5] = SETTINGS_DEFAULT_PANEL;
 
 // Flag indicating finish of SPI transmission to OLED
 volatile uint8_t SPI1_TX_completed_flag = 1;
@@ -108,33 +79,14 @@ volatile uint8_t SPI1_TX_completed_flag = 1;
 // Flag indicating finish of SPI start-up initialization
 volatile uint8_t Init_Completed_flag = 0;
 
-// Diagnostics
-char AuxDiagString[30] = "";
-
 /* Private function prototypes ------------------------------------------------------------------*/
 void SystemClock_Config(void);
 
 //******************************************************************************
 
 // TFT LCD settings
-void AdaFruit_Init(void);
-void BuyDisplay_Init(void);
-uint32_t boot_LCD_VBPD;
-uint32_t boot_LCD_VFPD;
-uint32_t boot_LCD_VSPW;
-uint32_t boot_LCD_HBPD;
-uint32_t boot_LCD_HFPD;
-uint32_t boot_LCD_HSPW;
-uint32_t boot_REFRESH_RATE;
-char boot_ADA_BUY[5];
-uint32_t setting_LCD_VBPD;
-uint32_t setting_LCD_VFPD;
-uint32_t setting_LCD_VSPW;
-uint32_t setting_LCD_HBPD;
-uint32_t setting_LCD_HFPD;
-uint32_t setting_LCD_HSPW;
-uint32_t setting_REFRESH_RATE;
-char setting_ADA_BUY[5];
+Settings boot_settings;		// As found in Flash at boot, for the timing adjust screen
+Settings settings;			// Current settings, saved as one record
 
 // BluePill clone determination/tests
 volatile uint32_t dbg_sysclk_hz = 0;
@@ -144,29 +96,10 @@ volatile uint32_t dbg_pclk2_hz = 0;
 volatile uint32_t dbg_clock_source = 0;
 volatile uint32_t dbg_hse_ready = 0;
 volatile uint32_t dbg_pll_ready = 0;
-volatile uint32_t dbg_loop_count = 0;
-volatile uint32_t dbg_loop_per_sec = 0;
-volatile uint32_t dbg_loop_last_ms = 0;
-volatile uint32_t dbg_loop_test_done = 0;
 
 //******************************************************************************
 
 
-// Diagnostics
-static char SafeDiagChar(char c)
-{
-	if (c < 0x20 || c > 0x7E)
-		return '?';
-
-	return c;
-}
-
-
-// Buffer to store the converted string representation of the main display line
-//char main_display_line[CHAR_COUNT + 1]; // +1 for null terminator
-static char main_display_line[CHAR_COUNT + 1]; // Static ensures scope is global within the file
-
-
 //SPI transmission finished interrupt callback
 void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi) {
 	if (hspi->Instance == SPI1)
@@ -176,390 +109,6 @@ void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi) {
 }
 
 
-//******************************************************************************
-static uint8_t InverseByte(uint8_t a) {
-	a = ((a & 0x55) << 1) | ((a & 0xAA) >> 1);
-	a = ((a & 0x33) << 2) | ((a & 0xCC) >> 2);
-	return (a >> 4) | (a << 4);
-}
-
-
-//******************************************************************************
-// Function to map character bitmaps to ASCII characters
-typedef struct {
-	uint8_t bitmap[7]; // 7 bytes for 5x7 character bitmaps
-	char ascii;        // Corresponding ASCII character
-} BitmapChar;
-
-
-// Font data: 96 characters, 7 bytes per character (each row)
-// These are relative to ISO 8859-1 which is the font installed in the LT7680A-R
-const BitmapChar bitmap_characters[] = {
-	{{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, ' '},  // Space
-	{{0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04}, '!'},  // 0x21, !
-	{{0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00}, '"'},  // 0x22, "
-	{{0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A}, '#'},  // 0x23, #
-	{{0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04}, '$'},  // 0x24, $
-	{{0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}, '%'},  // 0x25, %
-	{{0x04, 0x0A, 0x0A, 0x0A, 0x15, 0x12, 0x0D}, '&'},  // 0x26, &
-	{{0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00}, '\''}, // 0x27, '
-	{{0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}, '('},  // 0x28, (
-	{{0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}, ')'},  // 0x29, )
-	{{0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00}, '*'},  // 0x2A, *
-	{{0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}, '+'},  // 0x2B, +
-	{{0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08}, ','},  // 0x2C, ,
-	{{0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}, '-'},  // 0x2D, -
-	{{0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}, '.'},  // 0x2E, .
-	{{0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x10}, '/'},  // 0x2F, /
-	{{0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, '0'},  // 0x30, 0
-	{{0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}, '1'},  // 0x31, 1
-	{{0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, '2'},  // 0x32, 2
-	{{0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}, '3'},  // 0x33, 3
-	{{0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, '4'},  // 0x34, 4
-	{{0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}, '5'},  // 0x35, 5
-	{{0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, '6'},  // 0x36, 6
-	{{0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}, '7'},  // 0x37, 7
-	{{0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, '8'},  // 0x38, 8
-	{{0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}, '9'},  // 0x39, 9
-	{{0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}, ':'},  // 0x3A, :
-	{{0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08}, ';'},  // 0x3B, ;
-	{{0x00, 0x02, 0x06, 0x0E, 0x06, 0x02, 0x00}, '\x11'},  // 0x3C, <
-	{{0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}, '='},  // 0x3D, =
-	{{0x00, 0x08, 0x0C, 0x0E, 0x0C, 0x08, 0x00}, '\x10'},  // 0x3E, >
-	{{0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04}, '?'},  // 0x3F, ?
-	{{0x0E, 0x11, 0x17, 0x15, 0x17, 0x10, 0x0F}, '@'},  // 0x40, @
-	{{0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, 'A'},  // 0x41, A
-	{{0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, 'B'},  // 0x42, B
-	{{0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, 'C'},  // 0x43, C
-	{{0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, 'D'},  // 0x44, D
-	{{0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, 'E'},  // 0x45, E
-	{{0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, 'F'},  // 0x46, F
-	{{0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, 'G'},  // 0x47, G
-	{{0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, 'H'},  // 0x48, H
-	{{0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, 'I'},  // 0x49, I
-	{{0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, 'J'},  // 0x4A, J
-	{{0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, 'K'},  // 0x4B, K
-	{{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, 'L'},  // 0x4C, L
-	{{0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, 'M'},  // 0x4D, M
-	{{0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, 'N'},  // 0x4E, N
-	{{0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, 'O'},  // 0x4F, O
-	{{0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, 'P'},  // 0x50, P
-	{{0x0E, 0x11, 0x11, 0x11, 0x15, 0x13, 0x0D}, 'Q'},  // 0x51, Q
-	{{0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, 'R'},  // 0x52, R
-	{{0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, 'S'},  // 0x53, S
-	{{0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, 'T'},  // 0x54, T
-	{{0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, 'U'},  // 0x55, U
-	{{0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, 'V'},  // 0x56, V
-	{{0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, 'W'},  // 0x57, W
-	{{0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, 'X'},  // 0x58, X
-	{{0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}, 'Y'},  // 0x59, Y
-	{{0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, 'Z'},  // 0x5A, Z
-	{{0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E}, '['},  // 0x5B, [
-	//{{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, '['},  // 0x5B, [
-	{{0x10, 0x08, 0x04, 0x02, 0x01, 0x02, 0x04}, '\\'}, // 0x5C, backslash
-	{{0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E}, ']'},  // 0x5D, ]
-	//{{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, ']'},  // 0x5D, ]
-	{{0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x01}, '^'},  // 0x5E, ^
-	{{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}, '_'},  // 0x5F, _
-	{{0x01, 0x02, 0x04, 0x00, 0x00, 0x00, 0x00}, '`'},  // 0x60, `
-	{{0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F}, 'a'},  // 0x61, a
-	{{0x10, 0x10, 0x10, 0x1E, 0x11, 0x11, 0x1E}, 'b'},  // 0x62, b
-	{{0x00, 0x00, 0x0F, 0x10, 0x10, 0x10, 0x0F}, 'c'},  // 0x63, c
-	{{0x01, 0x01, 0x01, 0x0F, 0x11, 0x11, 0x0F}, 'd'},  // 0x64, d
-	{{0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0F}, 'e'},  // 0x65, e
-	{{0x02, 0x05, 0x04, 0x1F, 0x04, 0x04, 0x04}, 'f'},  // 0x66, f
-	{{0x00, 0x00, 0x0F, 0x11, 0x0F, 0x01, 0x1F}, 'g'},  // 0x67, g
-	{{0x10, 0x10, 0x10, 0x1E, 0x11, 0x11, 0x11}, 'h'},  // 0x68, h
-	{{0x00, 0x04, 0x00, 0x04, 0x04, 0x04, 0x04}, 'i'},  // 0x69, i
-	{{0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C}, 'j'},  // 0x6A, j
-	{{0x08, 0x08, 0x09, 0x0A, 0x0C, 0x0A, 0x09}, 'k'},  // 0x6B, k
-	{{0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, 'l'},  // 0x6C, l
-	{{0x00, 0x00, 0x1A, 0x15, 0x15, 0x15, 0x11}, 'm'},  // 0x6D, m
-	{{0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11}, 'n'},  // 0x6E, n
-	{{0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E}, 'o'},  // 0x6F, o
-	{{0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10}, 'p'},  // 0x70, p
-	{{0x00, 0x00, 0x0F, 0x11, 0x0F, 0x01, 0x01}, 'q'},  // 0x71, q
-	//{{0x00, 0x00, 0x0D, 0x13, 0x0F, 0x01, 0x01}, 'q'},  // 0x71, q
-	{{0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10}, 'r'},  // 0x72, r
-	{{0x00, 0x00, 0x0F, 0x10, 0x0E, 0x01, 0x1E}, 's'},  // 0x73, s
-	{{0x04, 0x04, 0x1F, 0x04, 0x04, 0x05, 0x02}, 't'},  // 0x74, t
-	{{0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D}, 'u'},  // 0x75, u
-	{{0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04}, 'v'},  // 0x76, v
-	{{0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A}, 'w'},  // 0x77, w
-	{{0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11}, 'x'},  // 0x78, x
-	//{{0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x00}, 'x'},  // 0x78, x	{0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11}
-	{{0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x1E}, 'y'},  // 0x79, y
-	{{0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F}, 'z'},  // 0x7A, z
-	{{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, '{'},  // 0x7B, {
-	{{0x01, 0x02, 0x04, 0x00, 0x04, 0x02, 0x01}, '|'},  // 0x7C, |
-	{{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, '}'},  // 0x7D, }
-	{{0x00, 0x00, 0x09, 0x15, 0x12, 0x00, 0x00}, '~'},  // 0x7E, ~
-	{{0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}, '/'},  // forward slash
-	{{0x06, 0x09, 0x09, 0x06, 0x00, 0x00, 0x00}, '°'},	// DegC symbol
-	{{0x0E, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x1B}, '$'},	// Ohm symbol placeholder, uses the $ symbol for detection of Ohm symbol - Not used on 6243/4
-	{{0x11, 0x12, 0x14, 0x0B, 0x11, 0x02, 0x03}, '½'},	// half symbol
-	{{0x00, 0x00, 0x04, 0x0E, 0x1F, 0x00, 0x00}, '\x1E'},	// up arrow
-	{{0x00, 0x00, 0x1F, 0x0E, 0x04, 0x00, 0x00}, '\x1F'},	// down arrow
-	{{0x00, 0x00, 0x09, 0x09, 0x09, 0x09, 0x16}, '\xB5' },	// micro u
-	{{0x00, 0x04, 0x02, 0x1F, 0x02, 0x04, 0x00}, '\x1A' },	// arrow right
-	{{0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F}, '\x08' },	// Diag mode display check 1		Unit separator usually. all pixels lit, this one appears on the display chack and the memorycard file name selection (albeit invalid)
-	{{0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F}, '\x01' },	// Diag mode display check 2
-	{{0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F}, '\x02' },	// Diag mode display check 3
-	{{0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F}, '\x03' },	// Diag mode display check 4
-	{{0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F}, '\x04' },	// Diag mode display check 5
-	{{0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F}, '\x05' },	// Diag mode display check 6
-	{{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}, '\x06' },	// Diag mode display check 7
-	{{0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F}, '\x07' },	// Diag mode display check 8
-	{{0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07}, '\x0B' },	// Diag mode display check 9
-	{{0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03}, '\x0C' },	// Diag mode display check 10
-	{{0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01}, '\x16' },	// Diag mode display check 11
-	{{0x10, 0x10, 0x14, 0x12, 0x1F, 0x02, 0x04}, '\x1A' },  // arrow right for R6243 menu char
-	{{0x00, 0x04, 0x0E, 0x1F, 0x0E, 0x04, 0x00}, '\x04' },  // diamond for R6243 main menu char
-};
-
-
-// Convert a 5x7 bitmap to an ASCII character
-// The bitmap (7 rows of 5 bits each) is compared row by row against the font_data.
-// The comparison involves the 7 rows of the bitmap against the corresponding 7 rows in each font_data entry.
-char BitmapToChar(const uint8_t* bitmap) {
-	// Iterate over the bitmap_characters array
-	for (int i = 0; i < sizeof(bitmap_characters) / sizeof(BitmapChar); i++) {
-		// Compare the input bitmap with the current character's bitmap
-		if (memcmp(bitmap, bitmap_characters[i].bitmap, FONT_HEIGHT) == 0) {
-			return bitmap_characters[i].ascii; // Return the matching ASCII character
-		}
-	}
-
-	// uncomment this to capture the unmatched bitmap and use LIVE WATCH to display the array for it
-	//memcpy(unmatchedBitmap, bitmap, FONT_HEIGHT);
-
-	// If no match is found, return '?'.
-	// If you see a '?' on the TFT then you know you are missing an entry in the bitmap_characters array, or an existing entry is wrong.
-	return '?';
-}
-
-
-//******************************************************************************
-
-// Each character on the display is encoded by a matrix of 40 bits packed
-// into 5 consecutive bytes. 5x7=35 bits (S1-S35) define the pixel image of the character,
-// 1 bit (S36) is the annunciator, 4 bits are not used. To optimize VFD PCB routing,
-// the bit order in packets is shuffled:
-//
-// S17 S16 S15 S14 S13 S12 S11 S10
-// S9  S8  S7  S6  S5  S4  S3  S2
-// S1  S36 0   0   0   0   S35 S34
-// S33 S32 S31 S30 S29 S28 S27 S26
-// S25 S24 S23 S22 S21 S20 S19 S18
-//
-// The Packets_to_chars function sorts the character bitmap, extracts the annunciator
-// flag, and stores the result in separate arrays chars[][] and flags[]
-//
-// 0 0 0 S1  S2  S3  S4  S5
-// 0 0 0 S6  S7  S8  S9  S10
-// 0 0 0 S11 S12 S13 S14 S15
-// 0 0 0 S16 S17 S18 S19 S20
-// 0 0 0 S21 S22 S23 S24 S25
-// 0 0 0 S26 S27 S28 S29 S30
-// 0 0 0 S31 S32 S33 S34 S35
-//
-void Packets_to_chars(void) {
-	for (int i = 0; i < PACKET_COUNT; i++) {
-		uint8_t d0 = rx_buffer[i * PACKET_WIDTH + 0];
-		uint8_t d1 = rx_buffer[i * PACKET_WIDTH + 1];
-		uint8_t d2 = rx_buffer[i * PACKET_WIDTH + 2];
-		uint8_t d3 = rx_buffer[i * PACKET_WIDTH + 3];
-		uint8_t d4 = rx_buffer[i * PACKET_WIDTH + 4];
-
-		chars[Reorder[i]][0] = 0x1F & InverseByte((d1 << 4) | ((d2 & 0x80) >> 4));
-		chars[Reorder[i]][1] = 0x1F & InverseByte((d0 << 7) | ((d1 & 0xF0) >> 1));
-		chars[Reorder[i]][2] = 0x1F & InverseByte((d0 & 0xFE) << 2);
-		chars[Reorder[i]][3] = 0x1F & InverseByte(((d0 & 0xC0) >> 3) | (d4 << 5));
-		chars[Reorder[i]][4] = 0x1F & InverseByte(d4 & 0xF8);
-		chars[Reorder[i]][5] = 0x1F & InverseByte(d3 << 3);
-		chars[Reorder[i]][6] = 0x1F & InverseByte((d2 << 6) | ((d3 & 0xE0) >> 2));
-		flags[Reorder[i]] = (d2 & 0x40) == 0x40;
-
-		// Update annunciator boolean array for MAIN annunciators (G1 to G18)
-		if (i < 37) {
-			AnnuncTemp[i] = flags[Reorder[i]];
-		}
-	}
-	// Null-terminate the main display line string
-	main_display_line[LINE1_LEN] = '\0';
-}
-
-
-void ReorderAnnunciators(void) {
-	// Map AnnuncTemp[] to Annunc[] for left-to-right order.
-	// 8, 7, 6, 5, 4, 3, 2, 1, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9
-	// See 'Order of data packets' on MickleT's schematic
-	Annunc[1] = AnnuncTemp[8];  // G1		SAMPLE
-	Annunc[2] = AnnuncTemp[7];  // G2		IDLE
-	Annunc[3] = AnnuncTemp[6];  // G3		AUTO
-	Annunc[4] = AnnuncTemp[5];  // G4		LOP
-	Annunc[5] = AnnuncTemp[4];  // G5		NULL
-	Annunc[6] = AnnuncTemp[3];  // G6		DFILT
-	Annunc[7] = AnnuncTemp[2];  // G7		MATH
-	Annunc[8] = AnnuncTemp[1];  // G8		AZERO
-	Annunc[9] = AnnuncTemp[0];  // G9		ERR
-	Annunc[10] = AnnuncTemp[35]; // G10		INFO
-	Annunc[11] = AnnuncTemp[34]; // G11		FRONT
-	Annunc[12] = AnnuncTemp[33]; // G12		REAR
-	Annunc[13] = AnnuncTemp[32]; // G13		SLOT
-	Annunc[14] = AnnuncTemp[31]; // G14		LO.G
-	Annunc[15] = AnnuncTemp[30]; // G15		RMT
-	Annunc[16] = AnnuncTemp[29]; // G16		TLK
-	Annunc[17] = AnnuncTemp[28]; // G17		LSN
-	Annunc[18] = AnnuncTemp[27]; // G18		SRQ
-}
-
-
-void Main_Aux(void) {
-	// Clear LCD buffers
-	memset(LCD_buffer_packets, 0, sizeof(LCD_buffer_packets));
-	memset(LCD_buffer_bitmaps, 0, sizeof(LCD_buffer_bitmaps));
-	memset(LCD_buffer_chars, 0, sizeof(LCD_buffer_chars));
-
-	ReorderAnnunciators(); // re-order the annunciators so Annunnciator[1] is above G1
-	//char annunciator_debug[256] = "Annunciators: "; // Buffer for annunciator state debug
-
-	for (int i = 0; i <= 17; i++) {
-		// G1 to G18
-		// Use already-decoded data from Packets_to_chars
-		uint8_t* bitmap = chars[i]; // Get the bitmap for this character
-		char ascii_char = BitmapToChar(bitmap); // Convert bitmap to ASCII character
-
-		// MAIN Update individual variables G1 to G18
-		if (i == 0) G[1] = ascii_char;
-		else if (i == 1) G[2] = ascii_char;
-		else if (i == 2) G[3] = ascii_char;
-		else if (i == 3) G[4] = ascii_char;
-		else if (i == 4) G[5] = ascii_char;
-		else if (i == 5) G[6] = ascii_char;
-		else if (i == 6) G[7] = ascii_char;
-		else if (i == 7) G[8] = ascii_char;
-		else if (i == 8) G[9] = ascii_char;
-		else if (i == 9) G[10] = ascii_char;
-		else if (i == 10) G[11] = ascii_char;
-		else if (i == 11) G[12] = ascii_char;
-		else if (i == 12) G[13] = ascii_char;
-		else if (i == 13) G[14] = ascii_char;
-		else if (i == 14) G[15] = ascii_char;
-		else if (i == 15) G[16] = ascii_char;
-		else if (i == 16) G[17] = ascii_char;
-		else if (i == 17) G[18] = ascii_char;
-	}
-
-	// Fill unused guard area with known pattern
-	for (int i = 48; i < 64; i++) {
-		G[i] = '#';
-	}
-
-	// Null-terminate the Main display debug string
-	main_display_debug[LINE1_LEN] = '\0';
-
-	for (int i = 18; i <= 46; i++) {
-		// G19 to G47
-		// Use already-decoded data from Packets_to_chars
-		uint8_t* bitmap = chars[i]; // Get the bitmap for character
-		char ascii_char = BitmapToChar(bitmap); // Convert bitmap to ASCII character
-
-		// AUX Update individual variables
-		if (i == 18) G[19] = ascii_char;
-		else if (i == 19) G[20] = ascii_char;
-		else if (i == 20) G[21] = ascii_char;
-		else if (i == 21) G[22] = ascii_char;
-		else if (i == 22) G[23] = ascii_char;
-		else if (i == 23) G[24] = ascii_char;
-		else if (i == 24) G[25] = ascii_char;
-		else if (i == 25) G[26] = ascii_char;
-		else if (i == 26) G[27] = ascii_char;
-		else if (i == 27) G[28] = ascii_char;
-		else if (i == 28) G[29] = ascii_char;
-		else if (i == 29) G[30] = ascii_char;
-		else if (i == 30) G[31] = ascii_char;
-		else if (i == 31) G[32] = ascii_char;
-		else if (i == 32) G[33] = ascii_char;
-		else if (i == 33) G[34] = ascii_char;
-		else if (i == 34) G[35] = ascii_char;
-		else if (i == 35) G[36] = ascii_char;
-		else if (i == 36) G[37] = ascii_char;
-		else if (i == 37) G[38] = ascii_char;
-		else if (i == 38) G[39] = ascii_char;
-		else if (i == 39) G[40] = ascii_char;
-		else if (i == 40) G[41] = ascii_char;
-		else if (i == 41) G[42] = ascii_char;
-		else if (i == 42) G[43] = ascii_char;
-		else if (i == 43) G[44] = ascii_char;
-		else if (i == 44) G[45] = ascii_char;
-		else if (i == 45) G[46] = ascii_char;
-		else if (i == 46) G[47] = ascii_char;
-
-		// Append AUX to debug buffers for additional debugging
-		snprintf(LCD_buffer_bitmaps + strlen(LCD_buffer_bitmaps),
-			sizeof(LCD_buffer_bitmaps) - strlen(LCD_buffer_bitmaps),
-			"%d : [%02X, %02X, %02X, %02X, %02X, %02X, %02X]\n",
-			i,
-			bitmap[0],
-			bitmap[1],
-			bitmap[2],
-			bitmap[3],
-			bitmap[4],
-			bitmap[5],
-			bitmap[6]);
-	}
-
-	// Build continuous AUX diagnostic string for DisplayAux()
-	{
-		uint8_t guard_ok = 1;
-		uint8_t bad_main_char = 0;
-		uint8_t bad_aux_char = 0;
-
-		for (int i = 48; i < 64; i++) {
-			if (G[i] != '#') {
-				guard_ok = 0;
-				break;
-			}
-		}
-
-		for (int i = 1; i <= 18; i++) {
-			unsigned char c = (unsigned char)G[i];
-
-			if (c < 0x20 || c > 0x7E) {
-				bad_main_char = 1;
-				break;
-			}
-		}
-
-		for (int i = 19; i <= 47; i++) {
-			unsigned char c = (unsigned char)G[i];
-
-			if (c < 0x20 || c > 0x7E) {
-				bad_aux_char = 1;
-				break;
-			}
-		}
-
-		snprintf(AuxDiagString, sizeof(AuxDiagString),
-			"M:%c%c%c%c A:%c%c%c%c E:%u%u G:%u",
-			SafeDiagChar(G[15]),
-			SafeDiagChar(G[16]),
-			SafeDiagChar(G[17]),
-			SafeDiagChar(G[18]),
-			SafeDiagChar(G[44]),
-			SafeDiagChar(G[45]),
-			SafeDiagChar(G[46]),
-			SafeDiagChar(G[47]),
-			bad_main_char,
-			bad_aux_char,
-			guard_ok);
-	}
-
-	// Null-terminate the Aux display debug string
-	main_display_debug[LINE2_LEN] = '\0';
-}
-
 
 //************************************************************************************************************************************************************
 //************************************************************************************************************************************************************
@@ -567,6 +116,8 @@ void Main_Aux(void) {
 // Main
 int main(void) {
 
+	Boot_ReadResetCause();			// Before anything else, power-on or warm restart
+
 	// Reset of all peripherals, Initializes the Flash interface and the Systick.
 	HAL_Init();
 
@@ -581,7 +132,6 @@ int main(void) {
 	dbg_clock_source = __HAL_RCC_GET_SYSCLK_SOURCE();
 	dbg_hse_ready = __HAL_RCC_GET_FLAG(RCC_FLAG_HSERDY);
 	dbg_pll_ready = __HAL_RCC_GET_FLAG(RCC_FLAG_PLLRDY);
-	volatile uint32_t dbg_loop_test_done = 0;
 
 	// Initialize all configured peripherals (except bit-bang SPI for S7701S LCD glass)
 	MX_GPIO_Init();					// I/O pins
@@ -589,7 +139,11 @@ int main(void) {
 	MX_SPI1_Init();					// SPI1 - LT760A-R
 	MX_SPI2_Init();					// SPI2 - VFD
 	
+	HAL_NVIC_SetPriority(PendSV_IRQn, IRQ_PRIO_BACKGROUND, 0);	// Deferred decode, below everything else
 	TIM2_Init();					// Initialize the timer
+	DWT_Init();						// Cycle counter for timestamps
+	Boot_Begin();					// Boot step timing, see 'b' on the debug channel
+	Debug_Init();					// USART2 debug channel
 
 	// Pull CS high and SCLK low immediately after reset
 	HAL_GPIO_WritePin(LCD_CS_Port, LCD_CS_Pin, GPIO_PIN_SET);			// Pull CS high
@@ -617,21 +171,59 @@ int main(void) {
 	//	AnnunColourFore = 0x00FFFF;		// Cyan
 	//}
 	
-	HardwareReset();				// Reset LT7680 - Pull LCM_RESET low for 100ms and wait
+	Timings_Init();
 
-	HAL_Delay(1000);
-	
-	SendAllToLT7680_LT();			// run subs to setup LT7680 based on Levetop info
+	// Load settings from EEProm (Flash), one record checked by magic, version, CRC and field ranges
+	SettingsSource settingsSource = Settings_Load(&settings);
+
+	// Copy retrieved vars from Flash for showing on splash screen
+	boot_settings = settings;
+
+	// Nothing valid stored: defaults were loaded, save them. Old layout: move it into the journal.
+	if (settingsSource != SETTINGS_LOADED) {
+		Settings_Save(&settings);
+	}
+
+	// Populate the final vars to be used
+	LCD_VBPD = settings.vbpd;
+	LCD_VFPD = settings.vfpd;
+	LCD_VSPW = settings.vspw;
+	LCD_HBPD = settings.hbpd;
+	LCD_HFPD = settings.hfpd;
+	LCD_HSPW = settings.hspw;
+	REFRESH_RATE = settings.refresh_rate;
+	strcpy(ADA_BUY, settings.panel);
+	LT7680_SetPLL(Timings_PLL(Timings_Find()));		// Worked out at run time only if the settings match no profile
+
+	Boot_Step("Settings", 1);
+
+	// ST7701S critical setting
+	if (strcmp(ADA_BUY, "BuyD") != 0) {
+		strcpy(ADA_BUY, "AdaF");		// Default - AdaFruit driver
+	}
 
-	HAL_Delay(10);
+	// Warm restart (debugger, watchdog, software reset, MCU brown-out): if the LT7680 still holds exactly the
+	// set-up the stored settings give it, the display bring-up is skipped. An LT7680 that lost power is back at
+	// its register defaults and fails the probe, so the reset cause is not needed here (it is shown with 'b').
+	// The ST7701S cannot be read back, it is assumed to have kept its set-up along with the LT7680.
+	boot_warm = LT7680_ConfigMatches();
+	Boot_Step("Warm probe", 1);
+
+	if (boot_warm) {
+		Text_Mode();
+		Boot_Step("Clear screen", ClearScreenFast());
+	}
+	else {
+		// Boot is paced by polling the LT7680 for readiness, not by fixed delays - see the boot log ('b')
+		Boot_Step("LT7680 reset", HardwareReset());	// Reset LT7680 - Pull LCM_RESET low and wait for it to come ready
+	
+		SendAllToLT7680_LT();			// run subs to setup LT7680 based on Levetop info, ends with the screen cleared
+	}
 
 	SetTimerDuration(35);			// Main loop timer - 35 ms timed action set
 
-	HAL_Delay(5);
 	ConfigurePWMAndSetBrightness(BACKLIGHTFULL);  // Configure Timer-1 and PWM-1 for backlighting. Settable 0-100%
 
-	ClearScreen();					// Again.....
-
 
 	// Determine delay to use for Delay_NonBlocking(n)
 	uint32_t DisplayDelay;
@@ -669,73 +261,14 @@ int main(void) {
 	}
 
 
-	// Load settings from EEProm (Flash)
-	setting_LCD_VBPD = EEPROM_ReadData(EEPROM_START_ADDRESS);
-	setting_LCD_VFPD = EEPROM_ReadData(EEPROM_START_ADDRESS + 4);
-	setting_LCD_VSPW = EEPROM_ReadData(EEPROM_START_ADDRESS + 8);
-	setting_LCD_HBPD = EEPROM_ReadData(EEPROM_START_ADDRESS + 12);
-	setting_LCD_HFPD = EEPROM_ReadData(EEPROM_START_ADDRESS + 16);
-	setting_LCD_HSPW = EEPROM_ReadData(EEPROM_START_ADDRESS + 20);
-	setting_REFRESH_RATE = EEPROM_ReadData(EEPROM_START_ADDRESS + 24);
-	EEPROM_Read4CharString(EEPROM_START_ADDRESS + 28, setting_ADA_BUY);
-
-
-	// Copy retrieved vars from Flash for showing on splash screen
-	boot_LCD_VBPD = setting_LCD_VBPD;
-	boot_LCD_VFPD = setting_LCD_VFPD;
-	boot_LCD_VSPW = setting_LCD_VSPW;
-	boot_LCD_HBPD = setting_LCD_HBPD;
-	boot_LCD_HFPD = setting_LCD_HFPD;
-	boot_LCD_HSPW = setting_LCD_HSPW;
-	boot_REFRESH_RATE = setting_REFRESH_RATE;
-	strcpy(boot_ADA_BUY, setting_ADA_BUY);
-
-	// Check if loaded values are ok, check VBPD is a value between 5 and 50
-	if (setting_LCD_VBPD < 5 || setting_LCD_VBPD > 50) {
-
-		// Assign default values
-		setting_LCD_VBPD = LCD_VBPD;
-		setting_LCD_VFPD = LCD_VFPD;
-		setting_LCD_VSPW = LCD_VSPW;
-		setting_LCD_HBPD = LCD_HBPD;
-		setting_LCD_HFPD = LCD_HFPD;
-		setting_LCD_HSPW = LCD_HSPW;
-		setting_REFRESH_RATE = REFRESH_RATE;
-		strcpy(setting_ADA_BUY, ADA_BUY);
-
-		EEPROM_ErasePage(EEPROM_START_ADDRESS) == HAL_OK;
-	
-		EEPROM_WriteData(EEPROM_START_ADDRESS, setting_LCD_VBPD);
-		EEPROM_WriteData(EEPROM_START_ADDRESS + 4, setting_LCD_VFPD);
-		EEPROM_WriteData(EEPROM_START_ADDRESS + 8, setting_LCD_VSPW);
-		EEPROM_WriteData(EEPROM_START_ADDRESS + 12, setting_LCD_HBPD);
-		EEPROM_WriteData(EEPROM_START_ADDRESS + 16, setting_LCD_HFPD);
-		EEPROM_WriteData(EEPROM_START_ADDRESS + 20, setting_LCD_HSPW);
-		EEPROM_WriteData(EEPROM_START_ADDRESS + 24, setting_REFRESH_RATE);
-		EEPROM_Write4CharString(EEPROM_START_ADDRESS + 28, setting_ADA_BUY);
-	
-	}
-
-	// Populate the final vars to be used
-	LCD_VBPD = setting_LCD_VBPD;
-	LCD_VFPD = setting_LCD_VFPD;
-	LCD_VSPW = setting_LCD_VSPW;
-	LCD_HBPD = setting_LCD_HBPD;
-	LCD_HFPD = setting_LCD_HFPD;
-	LCD_HSPW = setting_LCD_HSPW;
-	REFRESH_RATE = setting_REFRESH_RATE;
-	strcpy(ADA_BUY, setting_ADA_BUY);
-
-	// ST7701S critical setting
-	if (strcmp(ADA_BUY, "AdaF") == 0) {
-		AdaFruit_Init(); // Initialize AdaFruit driver
+	if (boot_warm) {
+		// Panel kept its set-up, see the warm restart probe above
 	}
 	else if (strcmp(ADA_BUY, "BuyD") == 0) {
 		BuyDisplay_Init(); // Initialize BuyDisplay driver
 	}
 	else {
-		strcpy(ADA_BUY, "AdaF");
-		AdaFruit_Init(); // Default - Initialize AdaFruit driver
+		AdaFruit_Init(); // Initialize AdaFruit driver
 	}
 
 	// Right wipe to clear random pixels down the far right hand side
@@ -747,28 +280,29 @@ int main(void) {
 	DrawLine(0, 954, 399, 954, 0x00, 0x00, 0x00);
 	DrawLine(0, 953, 399, 953, 0x00, 0x00, 0x00);
 	DrawLine(0, 952, 399, 952, 0x00, 0x00, 0x00);
+	Boot_Step("ST7701S init", 1);
 	
 //**************************************************************************************************
 // Main loop initialize
 
-	RunBluePillSpeedTestOffline();	// BluePill speed test
-	ClearScreen();					// Again.....
-
+	Boot_Done();
+	Trace_Start();					// Panel is set up, PB3 becomes SWO from here (see trace.c)
+	SpeedTest_Start();				// BluePill speed test, runs in the background from here
 	Init_Completed_flag = 1; // Now is a safe time to enable the EXTI interrupt handler
 
+	// Peripheral ownership - each task only ever touches its own peripherals, so nothing is paused or torn down:
+	//   Capture (capture.c, EXTI + DMA ISRs) owns SPI2 and DMA1 Ch4
+	//   Render  (timed action below: display.c, lt7680.c, lcd.c) owns SPI1, DMA1 Ch3 and the bit-bang ST7701S pins
+	//   Decode  (filter.c, decode.c, in PendSV via Main_DecodeFrame) works on RAM only
+	//   Debug   (debug.c, recorder.c) owns USART2 and DMA1 Ch7
+	// The main loop only renders; anything that reads the decoded state masks PendSV while it does so.
 	while (1) {
 
-		while (SPI1->SR & SPI_SR_BSY);					// Wait until any ongoing TFT SPI transfers are complete
-		SPI1->CR1 &= ~SPI_CR1_SPE;						// Disable the TFT SPI peripheral
-		DMA1_Channel3->CCR &= ~DMA_CCR_EN;				// Disable the TFT SPI DMA channels
-		NVIC_DisableIRQ(SPI1_IRQn);						// Disable TFT SPI NVIC interrupts to prevent any inadvertent triggering
+		__set_BASEPRI(DECODE_MASK);
+		Debug_Poll();					// Answer any debug channel command
+		__set_BASEPRI(0);
 
-		Packets_to_chars();         // Convert VFD packets from R6243 to characters
-		Main_Aux();					// Get R6243 VFD drive data
-
-		DMA1_Channel3->CCR |= DMA_CCR_EN;				// Re-enable the TFT DMA channel
-		SPI1->CR1 |= SPI_CR1_SPE;						// Re-enable the TFT SPI peripheral by setting its SPE bit
-		NVIC_EnableIRQ(SPI1_IRQn);						// Re-enable the TFT SPI NVIC interrupts
+		SpeedTest_Poll();				// Finishes the BluePill speed test once its window has passed
 
 		task_ready = 1; // Mark tasks as complete so the timer driven code is allowed to run again
 
@@ -780,31 +314,44 @@ int main(void) {
 		
 			if (timingModsOnBoot == false) {
 
-				// Wait for SPI2 to finish any ongoing transfers
-				while (SPI2->SR & SPI_SR_BSY);
-
-				// Pause SPI2 capture: Disable the SPI2 peripheral
-				SPI2->CR1 &= ~SPI_CR1_SPE;
-
-				// Pause the DMA channels used by SPI2
-				DMA1_Channel4->CCR &= ~DMA_CCR_EN;  // Disable SPI2 TX DMA
-				DMA1_Channel5->CCR &= ~DMA_CCR_EN;  // Disable SPI2 RX DMA
-
-				// Also disable the related NVIC interrupts for extra safety
-				NVIC_DisableIRQ(SPI2_IRQn);
-				NVIC_DisableIRQ(DMA1_Channel4_IRQn);
-				NVIC_DisableIRQ(DMA1_Channel5_IRQn);
+				// Capture keeps running while the TFT is drawn, the renderer never touches SPI2 or its DMA.
+				// Any frame damaged while rendering is counted so this can be checked on the unit.
+				uint32_t damagedBefore = Capture_FramesDamaged();
+				uint32_t busBefore = lt7680_bus_bytes;
+				Trace_Event(TRACE_RENDER_START, 0);
 
 				//HAL_GPIO_TogglePin(GPIOC, TEST_OUT_Pin); // Test LED toggle
 				GPIOC->ODR ^= TEST_OUT_Pin;		// faster write, bypasses HAL
 
+				// Decode waits until the whole screen is drawn from one consistent set of characters
+				__set_BASEPRI(DECODE_MASK);
+
+				PROFILE_BEGIN(PROFILE_DISPLAY_SPLASH);
 				DisplaySplash();
+				PROFILE_END(PROFILE_DISPLAY_SPLASH);
+
+				DisplaySpeedTest();
 
+				PROFILE_BEGIN(PROFILE_DISPLAY_MAIN);
 				DisplayMain();
+				PROFILE_END(PROFILE_DISPLAY_MAIN);
 
+				PROFILE_BEGIN(PROFILE_DISPLAY_AUX);
 				DisplayAux();
+				PROFILE_END(PROFILE_DISPLAY_AUX);
 
+				PROFILE_BEGIN(PROFILE_DISPLAY_ANNUNC);
 				DisplayAnnunciators();
+				PROFILE_END(PROFILE_DISPLAY_ANNUNC);
+
+				DisplayOverlay();
+
+				Latency_Rendered();		// Last register write of the pass is done, changes decoded before it are on the glass
+
+				__set_BASEPRI(0);
+
+				Trace_Event(TRACE_RENDER_END, 0);
+				Trace_Event(TRACE_BUS, (lt7680_bus_bytes - busBefore) >> TRACE_BUS_SHIFT);
 
 				// Right wipe to clear random pixels down the far right hand side - This may be required to run continiously
 				//DrawLine(0, 959, 399, 959, 0x00, 0x00, 0x00);	// far right hand vertical line, black, 1 pixel line. (this line hidden!)
@@ -825,21 +372,7 @@ int main(void) {
 
 				//Delay_NonBlocking(12);  // Wait 6ms in a non-blocking way
 
-				// Wait until SPI1 finishes any ongoing transactions
-				while (SPI1->SR & SPI_SR_BSY);
-
-				// Resume SPI2 capture:
-				// Re-enable DMA channels first
-				DMA1_Channel4->CCR |= DMA_CCR_EN;
-				DMA1_Channel5->CCR |= DMA_CCR_EN;
-
-				// Re-enable SPI2 by setting its SPE bit
-				SPI2->CR1 |= SPI_CR1_SPE;
-
-				// Re-enable the NVIC interrupts
-				NVIC_EnableIRQ(SPI2_IRQn);
-				NVIC_EnableIRQ(DMA1_Channel4_IRQn);
-				NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+				capture_frames_damaged_render += Capture_FramesDamaged() - damagedBefore;
 
 			} else {
 
@@ -861,65 +394,52 @@ int main(void) {
 
 						// On each press cycle round the various settings
 						// Rotate through the timing settings
-						currentTimingSet = (currentTimingSet + 1) % currentTimingSetNumberentries;  // Cycle through 0 to n
+						currentTimingSet = (currentTimingSet + 1) % Timings_Count();  // Cycle through the built-in then the user profiles
 						// Update the user settings based on the current set
 
 						if (isFirstPress == false) {
-							setting_LCD_VBPD = LCD_VBPD_SETTINGS[currentTimingSet];
-							setting_LCD_VFPD = LCD_VFPD_SETTINGS[currentTimingSet];
-							setting_LCD_VSPW = LCD_VSPW_SETTINGS[currentTimingSet];
-							setting_LCD_HBPD = LCD_HBPD_SETTINGS[currentTimingSet];
-							setting_LCD_HFPD = LCD_HFPD_SETTINGS[currentTimingSet];
-							setting_LCD_HSPW = LCD_HSPW_SETTINGS[currentTimingSet];
-							setting_REFRESH_RATE = REFRESH_RATE_SETTINGS[currentTimingSet];
-							strcpy(setting_ADA_BUY, ADA_BUY_SETTINGS[currentTimingSet]);
-
-							LCD_VBPD = setting_LCD_VBPD;
-							LCD_VFPD = setting_LCD_VFPD;
-							LCD_VSPW = setting_LCD_VSPW;
-							LCD_HBPD = setting_LCD_HBPD;
-							LCD_HFPD = setting_LCD_HFPD;
-							LCD_HSPW = setting_LCD_HSPW;
-							REFRESH_RATE = setting_REFRESH_RATE;
-							strcpy(ADA_BUY, setting_ADA_BUY);
-
-							// run startup subs again to apply new settings
-							AdaFruit_Init();
-
-							Delay_NonBlocking(5);  // Wait ms in a non-blocking way
-							LT7680_PLL_Initial_LT();
-
-							Delay_NonBlocking(5);  // Wait ms in a non-blocking way
-							LCD_Horizontal_Non_Display_LT(LCD_HBPD);  // Horizontal Back Porch
-
-							Delay_NonBlocking(5);  // Wait ms in a non-blocking way
-							LCD_HSYNC_Start_Position_LT(LCD_HFPD);    // HSYNC Start Position
-
-							Delay_NonBlocking(5);  // Wait ms in a non-blocking way
-							LCD_HSYNC_Pulse_Width_LT(LCD_HSPW);       // HSYNC Pulse Width
-
-							Delay_NonBlocking(5);  // Wait ms in a non-blocking way
-							LCD_Vertical_Non_Display_LT(LCD_VBPD);    // Vertical Back Porch
-
-							Delay_NonBlocking(5);  // Wait ms in a non-blocking way
-							LCD_VSYNC_Start_Position_LT(LCD_VFPD);    // VSYNC Start Position
-
-							Delay_NonBlocking(5);  // Wait ms in a non-blocking way
-							LCD_VSYNC_Pulse_Width_LT(LCD_VSPW);       // VSYNC Pulse Width
-
-							Delay_NonBlocking(5);  // Wait ms in a non-blocking way
-
-							EEPROM_ErasePage(EEPROM_START_ADDRESS) == HAL_OK;		// Erase Flash
-
-							// Save the updated settings to flash
-							EEPROM_WriteData(EEPROM_START_ADDRESS, setting_LCD_VBPD);
-							EEPROM_WriteData(EEPROM_START_ADDRESS + 4, setting_LCD_VFPD);
-							EEPROM_WriteData(EEPROM_START_ADDRESS + 8, setting_LCD_VSPW);
-							EEPROM_WriteData(EEPROM_START_ADDRESS + 12, setting_LCD_HBPD);
-							EEPROM_WriteData(EEPROM_START_ADDRESS + 16, setting_LCD_HFPD);
-							EEPROM_WriteData(EEPROM_START_ADDRESS + 20, setting_LCD_HSPW);
-							EEPROM_WriteData(EEPROM_START_ADDRESS + 24, setting_REFRESH_RATE);
-							EEPROM_Write4CharString(EEPROM_START_ADDRESS + 28, setting_ADA_BUY);
+							const TimingProfile* profile = Timings_Get(currentTimingSet);
+							uint32_t previousVBPD = LCD_VBPD;
+							uint32_t previousVFPD = LCD_VFPD;
+							_Bool panelChanged = strcmp(ADA_BUY, profile->panel) != 0;
+
+							settings.vbpd = profile->vbpd;
+							settings.vfpd = profile->vfpd;
+							settings.vspw = profile->vspw;
+							settings.hbpd = profile->hbpd;
+							settings.hfpd = profile->hfpd;
+							settings.hspw = profile->hspw;
+							settings.refresh_rate = profile->refresh_rate;
+							strcpy(settings.panel, profile->panel);
+
+							LCD_VBPD = settings.vbpd;
+							LCD_VFPD = settings.vfpd;
+							LCD_VSPW = settings.vspw;
+							LCD_HBPD = settings.hbpd;
+							LCD_HFPD = settings.hfpd;
+							LCD_HSPW = settings.hspw;
+							REFRESH_RATE = settings.refresh_rate;
+							strcpy(ADA_BUY, settings.panel);
+
+							// Apply the new set live. The ST7701S only needs its whole init table for a different
+							// panel, otherwise just the porches where the panel takes them from PORCTRL.
+							if (panelChanged) {
+								if (strcmp(ADA_BUY, "BuyD") == 0) {
+									BuyDisplay_Init();
+								}
+								else {
+									AdaFruit_Init();
+								}
+							}
+							else if (strcmp(ADA_BUY, "BuyD") == 0 && (LCD_VBPD != previousVBPD || LCD_VFPD != previousVFPD)) {
+								LCD_SetPorch((uint8_t)LCD_VBPD, (uint8_t)LCD_VFPD);
+							}
+							LT7680_SetPLL(Timings_PLL(profile));
+							LT7680_Retune();		// Only the LT7680 registers that changed
+
+							// Saved once the button has been left alone, not on every press
+							timingSavePending = true;
+							timingChangedTick = HAL_GetTick();
 						}
 
 						//HAL_Delay(6);
@@ -1021,14 +541,14 @@ int main(void) {
 						char redefineValuesCurr[128]; // Ensure the buffer is large enough
 						snprintf(redefineValuesCurr, sizeof(redefineValuesCurr),
 							"CURRENT %d   %d   %d    %d   %d   %d   %d   %s",
-							boot_LCD_VBPD,
-							boot_LCD_VFPD,
-							boot_LCD_VSPW,
-							boot_LCD_HBPD,
-							boot_LCD_HFPD,
-							boot_LCD_HSPW,
-							boot_REFRESH_RATE,
-							boot_ADA_BUY
+							boot_settings.vbpd,
+							boot_settings.vfpd,
+							boot_settings.vspw,
+							boot_settings.hbpd,
+							boot_settings.hfpd,
+							boot_settings.hspw,
+							boot_settings.refresh_rate,
+							boot_settings.panel
 						);
 						DrawText(redefineValuesCurr);
 
@@ -1053,14 +573,14 @@ int main(void) {
 							char redefineValues[128]; // Ensure the buffer is large enough
 							snprintf(redefineValues, sizeof(redefineValues),
 								"NEW     %d   %d   %d    %d   %d   %d   %d   %s",
-								setting_LCD_VBPD,
-								setting_LCD_VFPD,
-								setting_LCD_VSPW,
-								setting_LCD_HBPD,
-								setting_LCD_HFPD,
-								setting_LCD_HSPW,
-								setting_REFRESH_RATE,
-								setting_ADA_BUY
+								settings.vbpd,
+								settings.vfpd,
+								settings.vspw,
+								settings.hbpd,
+								settings.hfpd,
+								settings.hspw,
+								settings.refresh_rate,
+								settings.panel
 							);
 							DrawText(redefineValues);
 						}
@@ -1074,134 +594,56 @@ int main(void) {
 					isFirstPress = false;				// Reset the flag after the first press
 				}
 
+				// Save the chosen set to flash once the user has settled on it
+				if (timingSavePending && (HAL_GetTick() - timingChangedTick) >= TIMING_SAVE_IDLE_MS) {
+					Settings_Save(&settings);
+					timingSavePending = false;
+				}
+
 			}
 			
 
 		}
-	}
-
-}
-
-
-
-// Write uint32_t to EEprom (Flash)
-HAL_StatusTypeDef EEPROM_WriteData(uint32_t address, uint32_t data) {
-	if (address < EEPROM_START_ADDRESS || address >= (EEPROM_START_ADDRESS + EEPROM_PAGE_SIZE)) {
-		return HAL_ERROR; // Address out of range
-	}
-	HAL_FLASH_Unlock();
-	HAL_StatusTypeDef status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address, data);
-	HAL_FLASH_Lock();
-	return status;
-}
-
 
-// Write CHAR string to EEprom (Flash), 4 chars max
-HAL_StatusTypeDef EEPROM_Write4CharString(uint32_t address, const char* str) {
-	if (strlen(str) > 4) {
-		return HAL_ERROR; // Limit the string length to 4 characters
-	}
-
-	uint32_t data = 0;
-
-	// Copy up to 4 characters into a 32-bit word
-	memcpy(&data, str, 4);
-
-	HAL_FLASH_Unlock();
-	HAL_StatusTypeDef status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address, data);
-	HAL_FLASH_Lock();
-
-	return status;
-}
-
-
-// Read uint32_t from EEProm (Flash)
-uint32_t EEPROM_ReadData(uint32_t address) {
-	if (address < EEPROM_START_ADDRESS || address >= (EEPROM_START_ADDRESS + EEPROM_PAGE_SIZE)) {
-		return 0xFFFFFFFF; // Invalid address
+		//*******************************************************************************************
+		// Sleep until the next event: TIM2 (render due, the GP-IB LOCAL button is sampled on the render tick),
+		// debug channel or SysTick. Frames are decoded in PendSV as soon as a scan edge closes them, asleep or
+		// not. Checked with interrupts masked so an event that arrives in between is not slept
+		// through, WFI still wakes on it. The core stays awake while the speed test counts DWT cycles.
+		__disable_irq();
+		CPU_Idle(!timer_flag && !Debug_Pending() && SpeedTest_State() != SPEEDTEST_RUNNING);
+		__enable_irq();
 	}
-	return *(uint32_t*)address;
-}
-
-
-// Read CHAR string from EEprom (Flash), 4 chars max
-void EEPROM_Read4CharString(uint32_t address, char* buffer) {
-	uint32_t data = *(uint32_t*)address; // Read the 32-bit word
 
-	// Copy the data into the buffer
-	memcpy(buffer, &data, 4);
-
-	// Ensure the string is null-terminated
-	buffer[4] = '\0';
 }
 
 
 
-// Erase EEprom (Flash) - necessary before write
-HAL_StatusTypeDef EEPROM_ErasePage(uint32_t address) {
-	if (address < EEPROM_START_ADDRESS || address >= (EEPROM_START_ADDRESS + EEPROM_PAGE_SIZE)) {
-		return HAL_ERROR; // Address out of range
-	}
-
-	HAL_FLASH_Unlock();
-
-	FLASH_EraseInitTypeDef eraseInit;
-	uint32_t pageError;
-
-	eraseInit.TypeErase = FLASH_TYPEERASE_PAGES;
-	eraseInit.PageAddress = address;
-	eraseInit.NbPages = 1; // Erase a single page
-
-	HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&eraseInit, &pageError);
-
-	HAL_FLASH_Lock();
-	return status;
-}
-
-
-void RunBluePillSpeedTestOffline(void)
-{
-	// BluePill clone determination/test - standalone loop speed test when no comms is available
-	// Loops per sec is displayed on the TFT for 2secs at boot.
-	// Examples: Good board = 1497606, bad board = TBA
+// Deferred decode - called from PendSV_Handler, pended by the scan edge ISR each time it closes a complete frame.
+// Runs below every other interrupt, so capture is never held up and the main loop finds the decoded state ready.
+void Main_DecodeFrame(void) {
+	const uint8_t* frame = Capture_GetFrame();	// Each complete frame only once
+	if (frame != NULL) {
+		uint32_t seen;
+		uint32_t start = DWT_GetCycles();
+		frame = Filter_Frame(frame, Capture_GetFrameTime());	// Only let through changes that are stable over several scans
+		if (Filter_Changed(&seen)) {
+			Latency_Change(seen);	// Glass-to-glass clock runs from the scan the change first showed up in
+		}
 
-	dbg_loop_count = 0;
-	dbg_loop_per_sec = 0;
-	dbg_loop_test_done = 0;
+		PROFILE_BEGIN(PROFILE_PACKETS);
+		Packets_to_chars(frame);    // Convert VFD packets from R6243 to characters
+		PROFILE_END(PROFILE_PACKETS);
 
-	uint32_t test_start_ms = HAL_GetTick();
+		PROFILE_BEGIN(PROFILE_MAIN_AUX);
+		Main_Aux();					// Get R6243 VFD drive data
+		PROFILE_END(PROFILE_MAIN_AUX);
 
-	while ((HAL_GetTick() - test_start_ms) < 1000)
-	{
-		dbg_loop_count++;
+		Trace_Event(TRACE_DECODE, (DWT_GetCycles() - start) / (SystemCoreClock / 1000000));
 	}
-
-	dbg_loop_per_sec = dbg_loop_count;
-	dbg_loop_test_done = 1;
-
-	DisplayCloneDeterminationAux();
-
-	HAL_Delay(2000);
 }
 
 
-void RunBluePillSpeedTestOnline(void)
-{
-	// BluePill clone determination/test - Loops per sec is displayed on the TFT for 2secs at boot. Examples: Good board = 43596, Bad board = 849
-	if (!dbg_loop_test_done)
-	{
-		dbg_loop_count++;
-		uint32_t loop_now = HAL_GetTick();
-		if ((loop_now - dbg_loop_last_ms) >= 1000)
-		{
-			dbg_loop_per_sec = dbg_loop_count;
-			dbg_loop_test_done = 1;     // stop further testing
-			DisplayCloneDeterminationAux();
-			HAL_Delay(2000);
-		}
-	}
-}
-
 
 // System Clock Configuration
 void SystemClock_Config(void) {
@@ -0,0 +1,257 @@
+/**
+  ******************************************************************************
+  * @file    recorder.c
+  * @brief   This file provides code for recording raw VFD
+  *          frames over USART2 with DMA
+  ******************************************************************************
+*/
+
+// Send 'r' on the debug channel to start or stop recording. Every complete frame is then
+// delta-compressed against the previous one and queued in a ring buffer, which DMA1 Ch7
+// drains into USART2 TX, so the CPU never waits on the UART. Text output on the debug
+// channel is suppressed while recording so the stream stays clean.
+//
+// Recorder_Frame() is called from the scan edge ISR for every complete frame, whether or not the
+// main loop collects it. It only compares and copies ~235 bytes, the UART transfer runs on its own.
+//
+// To record on a PC: set the port to DEBUG_BAUD raw, send 'r', save everything received,
+// send 'r' again to stop. Host/rec_convert turns the recording into frames for decode_bench.
+
+#include "recorder.h"
+#include "capture.h"
+#include "debug.h"
+#include "main.h"
+#include "timer.h"
+#include <string.h>
+
+#define RECORDER_MAX_RECORD     (RECORDER_HEADER_SIZE + CAPTURE_FRAME_SIZE + 1)
+
+static uint8_t recorder_ring[RECORDER_RING_SIZE];
+static volatile uint16_t recorder_head = 0;            // Next byte to write, owned by Recorder_Frame
+static volatile uint16_t recorder_tail = 0;            // Next byte to send, owned by the DMA IRQ
+static volatile uint16_t recorder_tx_length = 0;       // Bytes in the DMA transfer in progress, 0 = idle
+
+static uint8_t recorder_previous[CAPTURE_FRAME_SIZE];
+static uint8_t recorder_record[RECORDER_MAX_RECORD];
+static volatile uint8_t recorder_active = 0;
+static uint8_t recorder_keyframe_due = 1;
+static uint16_t recorder_since_keyframe = 0;
+static uint16_t recorder_sequence = 0;
+
+volatile uint32_t recorder_frames_recorded = 0;
+volatile uint32_t recorder_frames_dropped = 0;
+
+
+// Start the next DMA transfer if the UART is idle. Must be called with interrupts disabled.
+static void StartTransfer(void) {
+    if (recorder_tx_length != 0 || recorder_head == recorder_tail) {
+        return;
+    }
+
+    // Send up to the end of the ring, the rest goes in the next transfer
+    uint16_t length = (recorder_head > recorder_tail) ? recorder_head - recorder_tail : RECORDER_RING_SIZE - recorder_tail;
+
+    recorder_tx_length = length;
+    DMA1_Channel7->CCR &= ~DMA_CCR_EN;
+    DMA1_Channel7->CMAR = (uint32_t)&recorder_ring[recorder_tail];
+    DMA1_Channel7->CNDTR = length;
+    DMA1_Channel7->CCR |= DMA_CCR_EN;
+}
+
+
+// Queue a record, returns 0 if there is not enough room
+static uint8_t Queue(const uint8_t* data, uint16_t length) {
+    uint16_t head = recorder_head;
+    uint16_t used = (uint16_t)((head - recorder_tail) & (RECORDER_RING_SIZE - 1));
+
+    if (length >= RECORDER_RING_SIZE - used) {
+        return 0;
+    }
+
+    uint16_t first = RECORDER_RING_SIZE - head;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(&recorder_ring[head], data, first);
+    memcpy(recorder_ring, data + first, length - first);
+
+    __disable_irq();
+    recorder_head = (uint16_t)((head + length) & (RECORDER_RING_SIZE - 1));
+    StartTransfer();
+    __enable_irq();
+
+    return 1;
+}
+
+
+// Fill in the header and checksum of recorder_record[], returns the total record length
+static uint16_t FinishRecord(uint8_t type, uint16_t payload, uint32_t timestamp) {
+    uint8_t* r = recorder_record;
+    uint8_t checksum = 0;
+
+    r[0] = RECORDER_SYNC;
+    r[1] = type;
+    r[2] = (uint8_t)payload;
+    r[3] = (uint8_t)(payload >> 8);
+    r[4] = (uint8_t)timestamp;
+    r[5] = (uint8_t)(timestamp >> 8);
+    r[6] = (uint8_t)(timestamp >> 16);
+    r[7] = (uint8_t)(timestamp >> 24);
+    r[8] = (uint8_t)recorder_sequence;
+    r[9] = (uint8_t)(recorder_sequence >> 8);
+
+    uint16_t length = RECORDER_HEADER_SIZE + payload;
+    for (uint16_t i = 0; i < length; i++) {
+        checksum ^= r[i];
+    }
+    r[length] = checksum;
+
+    return length + 1;
+}
+
+
+// Encode the changes since the previous frame, returns the payload length or 0xFFFF if a keyframe is smaller
+static uint16_t EncodeDelta(const uint8_t* frame, uint8_t* out) {
+    uint16_t n = 0;
+    int i = 0;
+
+    while (i < CAPTURE_FRAME_SIZE) {
+        if (frame[i] == recorder_previous[i]) {
+            i++;
+            continue;
+        }
+
+        // A run ends after 3 unchanged bytes, shorter gaps are cheaper to send than a new run header
+        int start = i;
+        int end = i + 1;
+        while (end < CAPTURE_FRAME_SIZE && end - start < 255) {
+            if (frame[end] != recorder_previous[end]) {
+                end++;
+            }
+            else if (end + 3 <= CAPTURE_FRAME_SIZE && memcmp(&frame[end], &recorder_previous[end], 3) != 0) {
+                end++;
+            }
+            else {
+                break;
+            }
+        }
+
+        uint8_t count = (uint8_t)(end - start);
+        if (n + 2 + count >= CAPTURE_FRAME_SIZE) {
+            return 0xFFFF;
+        }
+        out[n++] = (uint8_t)start;
+        out[n++] = count;
+        memcpy(&out[n], &frame[start], count);
+        n += count;
+        i = end;
+    }
+
+    return n;
+}
+
+
+// Start recording - switches the debug channel over to the binary stream
+void Recorder_Start(void) {
+    if (recorder_active) {
+        return;
+    }
+
+    // USART2 TX DMA, low priority so it never holds up the capture DMA
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    DMA1_Channel7->CCR = 0;
+    DMA1_Channel7->CPAR = (uint32_t)&USART2->DR;
+    DMA1_Channel7->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TCIE;     // Memory to peripheral, 8 bit, low priority
+    USART2->CR3 |= USART_CR3_DMAT;
+    HAL_NVIC_SetPriority(DMA1_Channel7_IRQn, IRQ_PRIO_USART_DMA, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel7_IRQn);
+
+    recorder_keyframe_due = 1;
+    recorder_frames_recorded = 0;
+    recorder_frames_dropped = 0;
+
+    uint8_t* p = &recorder_record[RECORDER_HEADER_SIZE];
+    uint32_t clock = SystemCoreClock;
+    p[0] = RECORDER_VERSION;
+    p[1] = CAPTURE_FRAME_SIZE;
+    p[2] = (uint8_t)clock;
+    p[3] = (uint8_t)(clock >> 8);
+    p[4] = (uint8_t)(clock >> 16);
+    p[5] = (uint8_t)(clock >> 24);
+    Queue(recorder_record, FinishRecord(RECORDER_START, 6, Timer_Stamp()));
+
+    recorder_active = 1;
+}
+
+
+// Stop recording, the debug channel goes back to text once the ring has drained
+void Recorder_Stop(void) {
+    if (!recorder_active) {
+        return;
+    }
+
+    recorder_active = 0;
+    Queue(recorder_record, FinishRecord(RECORDER_STOP, 0, Timer_Stamp()));
+
+    while (recorder_tx_length != 0);                                    // Let the DMA finish
+    while (!(USART2->SR & USART_SR_TC));
+    USART2->CR3 &= ~USART_CR3_DMAT;
+}
+
+
+uint8_t Recorder_Active(void) {
+    return recorder_active;
+}
+
+
+// Record one complete frame - called from the scan edge ISR
+void Recorder_Frame(const uint8_t* frame, uint32_t timestamp) {
+    if (!recorder_active) {
+        return;
+    }
+
+    uint8_t* payload = &recorder_record[RECORDER_HEADER_SIZE];
+    uint16_t length = 0xFFFF;
+    uint8_t type = RECORDER_DELTA;
+
+    if (!recorder_keyframe_due && recorder_since_keyframe < RECORDER_KEYFRAME_INTERVAL) {
+        length = EncodeDelta(frame, payload);
+    }
+    if (length == 0xFFFF) {
+        type = RECORDER_KEYFRAME;
+        length = CAPTURE_FRAME_SIZE;
+        memcpy(payload, frame, CAPTURE_FRAME_SIZE);
+    }
+
+    if (Queue(recorder_record, FinishRecord(type, length, timestamp))) {
+        memcpy(recorder_previous, frame, CAPTURE_FRAME_SIZE);
+        recorder_frames_recorded++;
+        if (type == RECORDER_KEYFRAME) {
+            recorder_keyframe_due = 0;
+            recorder_since_keyframe = 0;
+        }
+        else {
+            recorder_since_keyframe++;
+        }
+    }
+    else {
+        recorder_frames_dropped++;
+        recorder_keyframe_due = 1;      // The reader has lost track of the previous frame
+    }
+
+    recorder_sequence++;
+}
+
+
+// USART2 TX DMA complete
+void DMA1_Channel7_IRQHandler(void) {
+    if (DMA1->ISR & DMA_ISR_TCIF7) {
+        DMA1->IFCR = DMA_IFCR_CGIF7;
+
+        __disable_irq();
+        recorder_tail = (uint16_t)((recorder_tail + recorder_tx_length) & (RECORDER_RING_SIZE - 1));
+        recorder_tx_length = 0;
+        StartTransfer();
+        __enable_irq();
+    }
+}
@@ -0,0 +1,125 @@
+/**
+  ******************************************************************************
+  * @file    settings.c
+  * @brief   This file provides code for loading and saving
+  *          the settings record in the EEProm journal
+  ******************************************************************************
+*/
+
+// All settings are one packed Settings record, appended to the journal (eeprom.c) as a whole in a
+// single unlock/program/lock pass. Loading is one validation pass over the newest record: magic,
+// version, size, CRC, then the range of every field. Anything that fails gives the defaults.
+
+#include "settings.h"
+#include "eeprom.h"
+#include <stddef.h>
+#include <string.h>
+
+// Old firmware kept eight words here: VBPD, VFPD, VSPW, HBPD, HFPD, HSPW, refresh rate, 4 char panel
+#define LEGACY_ADDRESS          EEPROM_PAGE1_ADDRESS
+#define LEGACY_WORDS            8
+
+_Static_assert(sizeof(Settings) <= EEPROM_RECORD_MAX, "Settings record does not fit a journal slot");
+_Static_assert(offsetof(Settings, vbpd) == SETTINGS_HEADER_SIZE, "CRC must cover everything after the header");
+_Static_assert(sizeof(Settings) <= 255, "Settings size field is 8 bits");
+
+
+static uint8_t InRange(uint32_t value, uint32_t min, uint32_t max) {
+    return value >= min && value <= max;
+}
+
+
+// Field ranges, the LT7680 horizontal registers count in units of 8 pixels
+static uint8_t FieldsValid(const Settings* s) {
+    return InRange(s->vbpd, 5, 50)
+        && InRange(s->vfpd, 1, 255)
+        && InRange(s->vspw, 1, 255)
+        && InRange(s->hbpd, 8, 2048)
+        && InRange(s->hfpd, 0, 2048)
+        && InRange(s->hspw, 0, 256)
+        && InRange(s->refresh_rate, 30, 120)
+        && memchr(s->panel, '\0', sizeof(s->panel)) != NULL;
+}
+
+
+void Settings_Defaults(Settings* settings) {
+    memset(settings, 0, sizeof(*settings));
+    settings->vbpd = SETTINGS_DEFAULT_VBPD;
+    settings->vfpd = SETTINGS_DEFAULT_VFPD;
+    settings->vspw = SETTINGS_DEFAULT_VSPW;
+    settings->hbpd = SETTINGS_DEFAULT_HBPD;
+    settings->hfpd = SETTINGS_DEFAULT_HFPD;
+    settings->hspw = SETTINGS_DEFAULT_HSPW;
+    settings->refresh_rate = SETTINGS_DEFAULT_REFRESH;
+    strcpy(settings->panel, SETTINGS_DEFAULT_PANEL);
+}
+
+
+// Values from the old fixed-offset layout, only taken if they pass the same range checks
+static uint8_t LoadLegacy(Settings* settings) {
+    const uint32_t* words = (const uint32_t*)LEGACY_ADDRESS;
+    Settings legacy = *settings;
+
+    for (int i = 0; i < LEGACY_WORDS - 1; i++) {
+        if (words[i] > 0xFFFF) {
+            return 0;
+        }
+    }
+    legacy.vbpd = (uint16_t)words[0];
+    legacy.vfpd = (uint16_t)words[1];
+    legacy.vspw = (uint16_t)words[2];
+    legacy.hbpd = (uint16_t)words[3];
+    legacy.hfpd = (uint16_t)words[4];
+    legacy.hspw = (uint16_t)words[5];
+    legacy.refresh_rate = (uint16_t)words[6];
+    memcpy(legacy.panel, &words[7], 4);
+    legacy.panel[4] = '\0';
+
+    if (!FieldsValid(&legacy)) {
+        return 0;
+    }
+    *settings = legacy;
+    return 1;
+}
+
+
+// Load the newest settings record, settings holds the defaults for anything not loaded
+SettingsSource Settings_Load(Settings* settings) {
+    uint8_t record[EEPROM_RECORD_MAX];
+    Settings loaded;
+
+    Settings_Defaults(settings);
+    EEPROM_Init();
+
+    uint16_t length = EEPROM_Read(record, sizeof(record));
+    const Settings* stored = (const Settings*)record;
+
+    if (length < SETTINGS_HEADER_SIZE
+        || stored->magic != SETTINGS_MAGIC
+        || stored->version != SETTINGS_VERSION
+        || stored->size < SETTINGS_HEADER_SIZE || stored->size > length
+        || stored->crc != EEPROM_Crc16(EEPROM_CRC_INIT, &record[SETTINGS_HEADER_SIZE], (uint16_t)(stored->size - SETTINGS_HEADER_SIZE))) {
+        return LoadLegacy(settings) ? SETTINGS_LEGACY : SETTINGS_DEFAULTS;
+    }
+
+    // Older, shorter records leave the newer fields at their defaults, newer fields we do not know are dropped
+    loaded = *settings;
+    memcpy(&loaded, record, stored->size < sizeof(loaded) ? stored->size : sizeof(loaded));
+    if (!FieldsValid(&loaded)) {
+        return SETTINGS_DEFAULTS;
+    }
+
+    *settings = loaded;
+    return SETTINGS_LOADED;
+}
+
+
+// Stamp the header and append the whole record to the journal
+HAL_StatusTypeDef Settings_Save(Settings* settings) {
+    settings->magic = SETTINGS_MAGIC;
+    settings->version = SETTINGS_VERSION;
+    settings->size = sizeof(Settings);
+    settings->crc = EEPROM_Crc16(EEPROM_CRC_INIT, (const uint8_t*)settings + SETTINGS_HEADER_SIZE, sizeof(Settings) - SETTINGS_HEADER_SIZE);
+
+    return EEPROM_Append(settings, sizeof(Settings));
+}
@@ -0,0 +1,94 @@
+/**
+  ******************************************************************************
+  * @file    speedtest.c
+  * @brief   This file provides code for the background
+  *          BluePill clone determination
+  ******************************************************************************
+*/
+
+// Replaces the blocking boot speed test (1 s of loop counting plus a 2 s hold). The test now runs
+// in the background while the display is already live:
+//
+//   1. Core clock: DWT cycles counted over SPEEDTEST_WINDOW_MS of SysTick. A part whose DWT does not
+//      count, or whose clock is not what SystemCoreClock claims, is suspect. The main loop does not
+//      sleep during the window, so the count does not depend on the DWT running in WFI sleep.
+//   2. Loop rate: SPEEDTEST_LOOPS passes of the old test loop body (HAL_GetTick compare + counter),
+//      timed with the DWT and scaled to loops per second, so the figure compares with the old one.
+//
+// SpeedTest_Poll() is called from the main loop, step 2 takes ~13 ms and runs once. The result is
+// shown on the splash line by DisplaySpeedTest() and with 'b' on the debug channel.
+
+#include "speedtest.h"
+#include "timer.h"
+#include "stm32f1xx_hal.h"
+#include <stdio.h>
+
+static SpeedTestState speedtest_state = SPEEDTEST_IDLE;
+static uint32_t speedtest_start_ms = 0;
+static uint32_t speedtest_start_cycles = 0;
+
+volatile uint32_t dbg_loop_per_sec = 0;
+volatile uint32_t speedtest_core_hz = 0;
+volatile uint8_t speedtest_ok = 0;
+
+
+// Begin the clock measurement
+void SpeedTest_Start(void) {
+    speedtest_start_ms = HAL_GetTick();
+    speedtest_start_cycles = DWT_GetCycles();
+    speedtest_state = SPEEDTEST_RUNNING;
+}
+
+
+// The body of the old boot test loop, timed over a fixed count instead of a fixed second
+static uint32_t LoopRate(uint32_t core_hz) {
+    volatile uint32_t count = 0;
+    uint32_t start_ms = HAL_GetTick();
+    uint32_t start = DWT_GetCycles();
+
+    for (uint32_t i = 0; i < SPEEDTEST_LOOPS; i++) {
+        if ((HAL_GetTick() - start_ms) < 1000) {
+            count++;
+        }
+    }
+
+    uint32_t cycles = DWT_GetCycles() - start;
+    return cycles ? (uint32_t)((uint64_t)count * core_hz / cycles) : 0;
+}
+
+
+// Finish the test once the window has passed, call from the main loop
+void SpeedTest_Poll(void) {
+    if (speedtest_state != SPEEDTEST_RUNNING) {
+        return;
+    }
+
+    uint32_t elapsed_ms = HAL_GetTick() - speedtest_start_ms;
+    if (elapsed_ms < SPEEDTEST_WINDOW_MS) {
+        return;
+    }
+
+    uint32_t cycles = DWT_GetCycles() - speedtest_start_cycles;
+    speedtest_core_hz = (uint32_t)((uint64_t)cycles * 1000 / elapsed_ms);
+
+    // Without a counting DWT the loop rate falls back to the nominal clock
+    dbg_loop_per_sec = LoopRate(speedtest_core_hz ? speedtest_core_hz : SystemCoreClock);
+
+    uint32_t tolerance = SystemCoreClock / 1000 * SPEEDTEST_CLOCK_TOL_PM;
+    speedtest_ok = speedtest_core_hz + tolerance >= SystemCoreClock
+        && speedtest_core_hz <= SystemCoreClock + tolerance
+        && dbg_loop_per_sec >= SPEEDTEST_MIN_LOOPS;
+
+    speedtest_state = SPEEDTEST_DONE;
+}
+
+
+SpeedTestState SpeedTest_State(void) {
+    return speedtest_state;
+}
+
+
+// Short result text, e.g. "LS=1497606 OK"
+void SpeedTest_Format(char* buffer, uint8_t size) {
+    snprintf(buffer, size, "LS=%lu %s", (unsigned long)dbg_loop_per_sec, speedtest_ok ? "OK" : "SLOW");
+}
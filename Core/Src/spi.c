@@ -112,7 +112,7 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef *spiHandle)
         hdma_spi1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
         hdma_spi1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
         hdma_spi1_tx.Init.Mode = DMA_NORMAL;
-        hdma_spi1_tx.Init.Priority = DMA_PRIORITY_LOW;
+        hdma_spi1_tx.Init.Priority = DMA_PRIORITY_LOW;         // TFT can wait a few cycles, VFD capture cannot
         if (HAL_DMA_Init(&hdma_spi1_tx) != HAL_OK)
         {
             Error_Handler();
@@ -143,7 +143,7 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef *spiHandle)
         hdma_spi2_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
         hdma_spi2_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
         hdma_spi2_rx.Init.Mode = DMA_NORMAL;
-        hdma_spi2_rx.Init.Priority = DMA_PRIORITY_LOW;
+        hdma_spi2_rx.Init.Priority = DMA_PRIORITY_VERY_HIGH;   // VFD capture always wins DMA1 arbitration over the TFT and USART channels
         if (HAL_DMA_Init(&hdma_spi2_rx) != HAL_OK)
         {
             Error_Handler();
@@ -152,7 +152,7 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef *spiHandle)
         __HAL_LINKDMA(spiHandle, hdmarx, hdma_spi2_rx);
 
         /* SPI2 interrupt Init */
-        HAL_NVIC_SetPriority(SPI2_IRQn, 0, 0);
+        HAL_NVIC_SetPriority(SPI2_IRQn, IRQ_PRIO_CAPTURE_DMA, 0);
         HAL_NVIC_EnableIRQ(SPI2_IRQn);
     }
 }
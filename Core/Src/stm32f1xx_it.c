@@ -22,6 +22,8 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "capture.h"
+#include "profile.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -41,8 +43,7 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN PV */
-extern uint8_t rx_buffer[PACKET_WIDTH*PACKET_COUNT];
-extern uint8_t Init_Completed_flag;
+
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -176,7 +177,7 @@ void DebugMon_Handler(void)
 void PendSV_Handler(void)
 {
   /* USER CODE BEGIN PendSV_IRQn 0 */
-
+  Main_DecodeFrame();   // Decode the frame the scan edge ISR just closed
   /* USER CODE END PendSV_IRQn 0 */
   /* USER CODE BEGIN PendSV_IRQn 1 */
 
@@ -226,7 +227,7 @@ void DMA1_Channel4_IRQHandler(void)
   /* USER CODE BEGIN DMA1_Channel4_IRQn 0 */
 
   /* USER CODE END DMA1_Channel4_IRQn 0 */
-  HAL_DMA_IRQHandler(&hdma_spi2_rx);
+  Capture_DmaIRQHandler();          // SPI2 RX DMA is handled at register level, see capture.c
   /* USER CODE BEGIN DMA1_Channel4_IRQn 1 */
 
   /* USER CODE END DMA1_Channel4_IRQn 1 */
@@ -264,14 +265,9 @@ void EXTI15_10_IRQHandler(void)
 // Every 9 ms, during the start of a new display scan cycle, the S-IN56 signal is generated 
 // to load "1" into the chain of shift registers U5-U6. The edge of this signal is used as an 
 // interrupt source, which starts reading 47 packets of 5 bytes each (interrupt frequency ~111 Hz)
-  if (Init_Completed_flag) {
-      HAL_SPI_DMAStop(&hspi2);              // Used to ensure robustness when failures occur in SPI transfers.
-      HAL_SPI_Abort(&hspi2);                // ---- "" ----
-      __HAL_RCC_SPI2_FORCE_RESET();         // ---- "" ----
-      __HAL_RCC_SPI2_RELEASE_RESET();       // ---- "" ----
-      HAL_SPI_Init(&hspi2);                 // ---- "" ----
-      HAL_SPI_Receive_DMA (&hspi2, rx_buffer, PACKET_WIDTH*PACKET_COUNT);
-  }
+  PROFILE_BEGIN(PROFILE_CAPTURE_ISR);
+  Capture_ScanStart();
+  PROFILE_END(PROFILE_CAPTURE_ISR);
   /* USER CODE END EXTI15_10_IRQn 0 */
   HAL_GPIO_EXTI_IRQHandler(VFD_RESTART_Pin);
   /* USER CODE BEGIN EXTI15_10_IRQn 1 */
@@ -11,11 +11,18 @@
 // are met before running the dependent subroutine.  
 
 #include "timer.h"
+#include "main.h"
 
 // Timer flag variables
 volatile uint8_t timer_flag = 0;
 volatile uint8_t task_ready = 0;
 
+// CPU idle measurement
+volatile uint16_t cpu_idle_permille = 0;
+static uint32_t idle_busy_cycles = 0;
+static uint32_t idle_wake = 0;
+static uint32_t idle_window_start = 0;
+
 // Timer initialization function
 void TIM2_Init(void) {
     RCC->APB1ENR |= RCC_APB1ENR_TIM2EN; // Enable TIM2 clock
@@ -25,6 +32,7 @@ void TIM2_Init(void) {
     TIM2->DIER |= TIM_DIER_UIE;         // Enable update interrupt
     TIM2->CR1 |= TIM_CR1_CEN;           // Enable the timer
 
+    NVIC_SetPriority(TIM2_IRQn, IRQ_PRIO_RENDER_TICK);
     NVIC_EnableIRQ(TIM2_IRQn);          // Enable TIM2 interrupt in NVIC
 }
 
@@ -43,6 +51,56 @@ void SetTimerDuration(uint16_t ms) {
     TIM2->EGR = TIM_EGR_UG;    // Force update to apply changes immediately
 }
 
+// Enable the DWT cycle counter, used for timestamps and timing measurements
+void DWT_Init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;  // Enable trace and debug blocks
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;            // Start the cycle counter
+}
+
 
+// End of a main loop pass. Call with interrupts disabled, sleep = 1 if there is nothing left to do.
+// The core then sleeps in WFI until the next interrupt, which still wakes it while masked, and the
+// interrupt runs as soon as the caller re-enables interrupts. Time from wake-up to the next call
+// (interrupt handlers included) is counted as busy. The DWT counter may stop while asleep, so it only
+// times the awake part and the window is timed with the millisecond tick. Anything else that spans a
+// sleep is timed with Timer_Stamp().
+void CPU_Idle(uint8_t sleep) {
+    idle_busy_cycles += DWT->CYCCNT - idle_wake;
 
+    if (sleep) {
+        __WFI();
+    }
+    idle_wake = DWT->CYCCNT;
 
+    uint32_t elapsed = HAL_GetTick() - idle_window_start;
+    if (elapsed >= 1000) {
+        uint32_t window = elapsed * (SystemCoreClock / 1000);
+        uint32_t busy = (uint32_t)((uint64_t)idle_busy_cycles * 1000 / window);
+
+        cpu_idle_permille = (uint16_t)(busy >= 1000 ? 0 : 1000 - busy);
+        idle_busy_cycles = 0;
+        idle_window_start += elapsed;
+    }
+}
+
+
+// Time in CPU cycles built from the millisecond tick and the SysTick counter, same units and 2^32 wrap
+// as DWT_GetCycles(). SysTick runs on while the core sleeps in WFI, so this is the stamp for intervals
+// that span a sleep. Safe from interrupts above SysTick: a reload whose tick interrupt has not run yet
+// is counted in.
+uint32_t Timer_Stamp(void) {
+    uint32_t tick, val, pending;
+
+    do {
+        tick = uwTick;
+        val = SysTick->VAL;
+        pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+    } while (tick != uwTick);
+
+    uint32_t load = SysTick->LOAD;
+    if (pending && val > load / 2) {
+        tick++;                                     // Reloaded after the tick was read, HAL_IncTick() still to run
+    }
+    return tick * (load + 1) + (load - val);
+}
@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file    timings.c
+  * @brief   This file provides code for the TFT LCD
+  *          timing profiles
+  ******************************************************************************
+*/
+
+// The timing sets the timing adjust screen cycles through. The built-in ones are a const table in
+// Flash with their LT7680 PLL registers worked out at compile time, so selecting one needs no clock
+// arithmetic. More can be added without a firmware change by programming TimingProfile records into
+// the user profile area (TIMINGS_USER_ADDRESS), they follow the built-in ones in the cycle.
+
+#include "timings.h"
+#include <string.h>
+
+#define TIMINGS_USER_MAX    (TIMINGS_USER_SIZE / sizeof(TimingProfile))
+
+static const TimingProfile timings_builtin[] = {
+    //             VBPD VFPD VSPW HBPD HFPD HSPW REFR  COG
+    TIMING_PROFILE(17,  14,  2,   50,  30,  10,  60,   "AdaF"),
+    TIMING_PROFILE(17,  14,  3,   50,  30,  10,  60,   "AdaF"),
+    TIMING_PROFILE(17,  14,  4,   50,  30,  10,  60,   "AdaF"),
+    TIMING_PROFILE(17,  15,  2,   50,  30,  10,  60,   "AdaF"),
+    TIMING_PROFILE(17,  15,  2,   50,  30,  10,  45,   "AdaF"),
+    TIMING_PROFILE(10,  12,  3,   80,  30,  20,  60,   "BuyD"),
+};
+
+#define TIMINGS_BUILTIN     (sizeof(timings_builtin) / sizeof(timings_builtin[0]))
+
+_Static_assert(sizeof(TimingProfile) % 2 == 0, "Profiles must be programmable as half-words");
+_Static_assert(TIMINGS_XSIZE == LCD_XSIZE_TFT && TIMINGS_YSIZE == LCD_YSIZE_TFT, "Panel size differs from lt7680.h");
+_Static_assert(TIMINGS_SCLK_MAX == SCLK_MAX && TIMINGS_MCLK_MAX == MCLK_MAX && TIMINGS_CCLK_MAX == CCLK_MAX,
+    "Clock limits differ from lt7680.h");
+
+static uint8_t timings_user = 0;       // Valid records in the user area
+
+
+// Count the user profiles, call once at boot
+void Timings_Init(void) {
+    const TimingProfile* user = (const TimingProfile*)TIMINGS_USER_ADDRESS;
+
+    timings_user = 0;
+    while (timings_user < TIMINGS_USER_MAX && Timings_Valid(&user[timings_user])) {
+        timings_user++;
+    }
+}
+
+
+uint8_t Timings_Count(void) {
+    return (uint8_t)(TIMINGS_BUILTIN + timings_user);
+}
+
+
+// Built-in profiles first, then the user ones. NULL if out of range.
+const TimingProfile* Timings_Get(uint8_t index) {
+    if (index < TIMINGS_BUILTIN) {
+        return &timings_builtin[index];
+    }
+    if (index < Timings_Count()) {
+        return &((const TimingProfile*)TIMINGS_USER_ADDRESS)[index - TIMINGS_BUILTIN];
+    }
+    return NULL;
+}
+
+
+// The profile the current timings (LCD_VBPD etc.) came from, NULL if none matches
+const TimingProfile* Timings_Find(void) {
+    for (uint8_t i = 0; i < Timings_Count(); i++) {
+        const TimingProfile* p = Timings_Get(i);
+        if (p->vbpd == LCD_VBPD && p->vfpd == LCD_VFPD && p->vspw == LCD_VSPW
+            && p->hbpd == LCD_HBPD && p->hfpd == LCD_HFPD && p->hspw == LCD_HSPW
+            && p->refresh_rate == REFRESH_RATE) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+
+// Precomputed PLL registers of a profile, NULL = none (no profile, or a user profile that left them erased)
+const uint8_t* Timings_PLL(const TimingProfile* profile) {
+    static const uint8_t erased[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+    if (profile == NULL || memcmp(profile->pll, erased, sizeof(erased)) == 0) {
+        return NULL;
+    }
+    return profile->pll;
+}
@@ -0,0 +1,133 @@
+/**
+  ******************************************************************************
+  * @file    trace.c
+  * @brief   This file provides code for the ITM/SWO
+  *          pipeline event trace
+  ******************************************************************************
+*/
+
+// Pipeline events go out as ITM stimulus port writes on SWO, continuously and without stopping the
+// core, unlike LIVE WATCH which polls memory over SWD. Record format in trace.h.
+//
+// PB3 is both TRACESWO and LCD_CS for the bit-banged ST7701S link. It is only SWO while the trace holds
+// it: Trace_Start() claims it once the panel is set up, the ST7701S code calls Trace_ReleasePin() and
+// Trace_RestorePin() around anything it sends later (timing changes, the 't' benchmark).
+//
+// Claiming PB3 switches the debug port from SW-DP only (SWJ_CFG = 010, PB3/PB4/PA15 free) to full SWJ
+// without NJTRST (001): PB3 becomes JTDO/TRACESWO, PB4 stays a GPIO for LCD_SCK, PA15 (unused) becomes
+// JTDI. SWD keeps working in both.
+//
+// Events are dropped, not waited for, when the ITM FIFO is full, so a slow or absent SWO reader never
+// holds up the pipeline. With no debugger attached the ITM is still set up and the writes just go out.
+
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+#include "main.h"
+#include "timer.h"
+#include "stm32f1xx_hal.h"
+
+#define ITM_LOCK_KEY        0xC5ACCE55
+#define PB3_MODE_SHIFT      (3 * 4)         // PB3 CNF/MODE field in GPIOB->CRL
+#define PB3_OUTPUT_PP       0x3             // General purpose push-pull, 50 MHz
+#define PB3_AF_PP           0xB             // Alternate function push-pull, 50 MHz
+#define TRACE_PACKET_BITS   (5 * 10)        // One event on the wire, 5 bytes of start + 8 + stop bits
+#define TRACE_DRAIN_PACKETS 8               // Most events the ITM can still hold when the pin is released
+
+static volatile uint8_t trace_claimed = 0;
+
+volatile uint32_t trace_events = 0;
+volatile uint32_t trace_dropped = 0;
+
+
+static void SetPB3(uint32_t mode) {
+    GPIOB->CRL = (GPIOB->CRL & ~(0xFUL << PB3_MODE_SHIFT)) | (mode << PB3_MODE_SHIFT);
+}
+
+
+// Let the events already written get out on PB3 before it is switched over. Nothing to wait for if the
+// ITM is off (e.g. a debugger reconfigured it). Otherwise wait, bounded, for the ITM to go idle, then one
+// packet time for the TPIU to shift out the last one. The counts are loop passes, each takes several
+// cycles, so the waits are never shorter than intended and never hang.
+static void Drain(void) {
+    if (!(CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) || !(ITM->TCR & ITM_TCR_ITMENA_Msk)) {
+        return;
+    }
+
+    uint32_t packet = SystemCoreClock / TRACE_SWO_BAUD * TRACE_PACKET_BITS;
+    for (volatile uint32_t n = packet * TRACE_DRAIN_PACKETS; n != 0 && (ITM->TCR & ITM_TCR_BUSY_Msk); n--);
+    for (volatile uint32_t n = packet; n != 0; n--);
+}
+
+
+// Hand PB3 to the TPIU as TRACESWO
+static void ClaimPin(void) {
+    __HAL_AFIO_REMAP_SWJ_NONJTRST();
+    SetPB3(PB3_AF_PP);
+    DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;   // Asynchronous trace on PB3
+    trace_claimed = 1;
+}
+
+
+// Set up the ITM and TPIU for NRZ SWO and claim the pin, call once the ST7701S init is done
+void Trace_Start(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    TPI->SPPR = 2;                                          // NRZ
+    TPI->ACPR = SystemCoreClock / TRACE_SWO_BAUD - 1;
+    TPI->FFCR = 0x100;                                      // Formatter off, ITM only
+    ITM->LAR = ITM_LOCK_KEY;
+    ITM->TCR = ITM_TCR_ITMENA_Msk | ITM_TCR_SYNCENA_Msk | (1UL << ITM_TCR_TraceBusID_Pos);
+    ITM->TPR = 0;
+    ITM->TER = ((1UL << TRACE_EVENTS) - 1) & ~1UL;          // Ports 1..TRACE_EVENTS-1, port 0 left to printf-style use
+
+    ClaimPin();
+}
+
+
+// Give PB3 back as LCD_CS (high, idle). Returns 1 if the trace had it, pass that to Trace_RestorePin().
+uint8_t Trace_ReleasePin(void) {
+    if (!trace_claimed) {
+        return 0;
+    }
+
+    uint32_t primask = __get_PRIMASK();     // No event may start while the pin changes hands
+    __disable_irq();
+    trace_claimed = 0;
+    __set_PRIMASK(primask);
+
+    Drain();
+    DBGMCU->CR &= ~DBGMCU_CR_TRACE_IOEN;
+    LCD_CS_Port->BSRR = LCD_CS_Pin;
+    SetPB3(PB3_OUTPUT_PP);
+    __HAL_AFIO_REMAP_SWJ_NOJTAG();
+    return 1;
+}
+
+
+void Trace_RestorePin(uint8_t claimed) {
+    if (claimed) {
+        ClaimPin();
+    }
+}
+
+
+// Write one event, dropped if the pin is not claimed or the FIFO is full
+void Trace_Event(uint8_t event, uint32_t arg) {
+    if (!trace_claimed) {
+        return;
+    }
+
+    uint32_t time = (Timer_Stamp() >> TRACE_TIME_SHIFT) & ((1UL << TRACE_TIME_BITS) - 1);
+    uint32_t word = ((arg > TRACE_ARG_MAX ? TRACE_ARG_MAX : arg) << TRACE_TIME_BITS) | time;
+
+    if (ITM->PORT[event].u32 & 1) {
+        ITM->PORT[event].u32 = word;
+        trace_events++;
+    }
+    else {
+        trace_dropped++;
+    }
+}
+
+#endif // TRACE_ENABLED
@@ -0,0 +1,180 @@
+/**
+  ******************************************************************************
+  * @file    decode_bench.c
+  * @brief   Replay recorded VFD frames through the firmware
+  *          decoder and time it (PC only)
+  ******************************************************************************
+*/
+
+// Usage: decode_bench [-n loops] [-q] frames.bin
+//
+//   -n loops  number of timed passes over the file (default 100)
+//   -q        do not print the decoded screens
+//
+// frames.bin is a plain sequence of 235 byte frames, recorded from the unit or made with frame_gen.
+//
+// decode.c and glyphlog.c are compiled unchanged from Core/Src. Per stage times are taken
+// with a clock read around each call, so they include a few ns of clock overhead each.
+// Frames/s is measured separately over the full decode (Packets_to_chars + Main_Aux)
+// without the per stage clock reads.
+
+#include "decode.h"
+#include "glyphlog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FRAME_SIZE      (PACKET_WIDTH * PACKET_COUNT)
+
+static const char* annunc_names[19] = { "",
+    "SMPL", "IDLE", "AUTO", "LOP", "NULL", "DFILT", "MATH", "AZERO", "ERR",
+    "INFO", "FRONT", "REAR", "SLOT", "LO.G", "RMT", "TLK", "LSN", "SRQ" };
+
+
+static uint64_t NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+
+// Printable version of a decoded character
+static char Show(char c) {
+    if (c == '\x1A') return '>';    // Menu arrow
+    if (c == '\x04') return '*';    // Main menu diamond
+    if (c < 0x20 || c > 0x7E) return '.';
+    return c;
+}
+
+
+// Print the decoded screen
+static void PrintScreen(long frame) {
+    char main_line[LINE1_LEN + 1];
+    char aux_line[LINE2_LEN + 1];
+
+    for (int i = 0; i < LINE1_LEN; i++) main_line[i] = Show(G[1 + i]);
+    for (int i = 0; i < LINE2_LEN; i++) aux_line[i] = Show(G[1 + LINE1_LEN + i]);
+    main_line[LINE1_LEN] = 0;
+    aux_line[LINE2_LEN] = 0;
+
+    printf("%7ld  [%s] [%s]", frame, main_line, aux_line);
+    for (int i = 1; i <= 18; i++) {
+        if (Annunc[i]) printf(" %s", annunc_names[i]);
+    }
+    printf("\n");
+}
+
+
+int main(int argc, char** argv) {
+    long loops = 100;
+    int quiet = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:q")) != -1) {
+        switch (opt) {
+        case 'n': loops = strtol(optarg, NULL, 10); break;
+        case 'q': quiet = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-n loops] [-q] frames.bin\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1 || loops < 1) {
+        fprintf(stderr, "usage: %s [-n loops] [-q] frames.bin\n", argv[0]);
+        return 1;
+    }
+
+    // Load the recording
+    FILE* in = fopen(argv[optind], "rb");
+    if (in == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+
+    long count = size / FRAME_SIZE;
+    if (size % FRAME_SIZE != 0) {
+        fprintf(stderr, "warning: %ld trailing bytes ignored\n", size % FRAME_SIZE);
+    }
+    if (count == 0) {
+        fprintf(stderr, "%s: no complete frames\n", argv[optind]);
+        return 1;
+    }
+
+    uint8_t* frames = malloc((size_t)count * FRAME_SIZE);
+    if (frames == NULL || fread(frames, FRAME_SIZE, (size_t)count, in) != (size_t)count) {
+        fprintf(stderr, "%s: read failed\n", argv[optind]);
+        return 1;
+    }
+    fclose(in);
+
+    // Decode once and print every screen change
+    char previous[64] = { 0 };
+    _Bool previous_annunc[19] = { 0 };
+
+    for (long f = 0; f < count; f++) {
+        Packets_to_chars(&frames[f * FRAME_SIZE]);
+        Main_Aux();
+
+        if (!quiet && (f == 0 || memcmp(previous, G, sizeof(previous)) != 0 || memcmp(previous_annunc, Annunc, sizeof(previous_annunc)) != 0)) {
+            PrintScreen(f);
+        }
+        memcpy(previous, G, sizeof(previous));
+        memcpy(previous_annunc, Annunc, sizeof(previous_annunc));
+    }
+
+    // Time each stage
+    uint64_t t_packets = 0, t_reorder = 0, t_bitmap = 0, t_main_aux = 0;
+    volatile char sink = 0;
+
+    for (long l = 0; l < loops; l++) {
+        for (long f = 0; f < count; f++) {
+            uint64_t t0 = NowNs();
+            Packets_to_chars(&frames[f * FRAME_SIZE]);
+            uint64_t t1 = NowNs();
+            ReorderAnnunciators();
+            uint64_t t2 = NowNs();
+            for (int i = 0; i < CHAR_COUNT; i++) {
+                sink ^= BitmapToChar(chars[i], (uint8_t)(i + 1));
+            }
+            uint64_t t3 = NowNs();
+            Main_Aux();
+            uint64_t t4 = NowNs();
+
+            t_packets += t1 - t0;
+            t_reorder += t2 - t1;
+            t_bitmap += t3 - t2;
+            t_main_aux += t4 - t3;
+        }
+    }
+
+    // Time the full decode as the firmware runs it
+    uint64_t start = NowNs();
+    for (long l = 0; l < loops; l++) {
+        for (long f = 0; f < count; f++) {
+            Packets_to_chars(&frames[f * FRAME_SIZE]);
+            Main_Aux();
+        }
+    }
+    uint64_t total = NowNs() - start;
+
+    double decoded = (double)loops * (double)count;
+    printf("\n%ld frames x %ld loops\n", count, loops);
+    printf("  Packets_to_chars      %9.1f ns/frame\n", t_packets / decoded);
+    printf("  ReorderAnnunciators   %9.1f ns/frame\n", t_reorder / decoded);
+    printf("  BitmapToChar x %d     %9.1f ns/frame\n", CHAR_COUNT, t_bitmap / decoded);
+    printf("  Main_Aux              %9.1f ns/frame\n", t_main_aux / decoded);
+    printf("  Full decode           %9.1f ns/frame, %.0f frames/s\n", total / decoded, decoded * 1e9 / total);
+
+    if (glyph_log_misses != 0) {
+        printf("\n");
+        GlyphLog_Dump();
+    }
+
+    free(frames);
+    return 0;
+}
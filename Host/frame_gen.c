@@ -0,0 +1,210 @@
+/**
+  ******************************************************************************
+  * @file    frame_gen.c
+  * @brief   Synthesise binary VFD frames from text for
+  *          decode_bench (PC only)
+  ******************************************************************************
+*/
+
+// Usage: frame_gen screens.txt frames.bin
+//
+// Each line of the text file describes one R6243 screen:
+//
+//   MAIN|AUX|ANNUNCIATORS|SCANS
+//
+//   MAIN          up to 18 characters, G1 to G18, padded with spaces
+//   AUX           up to 29 characters, G19 to G47, padded with spaces
+//   ANNUNCIATORS  optional, up to 18 of '0'/'1', left to right SMPL IDLE AUTO ... SRQ
+//   SCANS         optional, number of identical frames to write (default 1, the R6243 scans at ~111 Hz)
+//
+// Characters that are not printable can be written as \xNN, e.g. \x1A for the menu arrow.
+// Lines that are empty or start with # are ignored.
+//
+// Each character is looked up in bitmap_characters[] and packed into its 5 byte packet
+// with the inverse of the shuffle undone by Packets_to_chars(). Every frame is run back
+// through Packets_to_chars() to check the packing before it is written.
+//
+// Output is a plain sequence of 235 byte frames, exactly as the DMA receives them.
+
+#include "decode.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_SIZE      (PACKET_WIDTH * PACKET_COUNT)
+#define ANNUNC_COUNT    18
+
+
+// Look up the bitmap of an ASCII character, returns NULL if the font has no such character
+static const uint8_t* FindBitmap(char c) {
+    for (int i = 0; i < bitmap_characters_count; i++) {
+        if (bitmap_characters[i].ascii == c) {
+            return bitmap_characters[i].bitmap;
+        }
+    }
+    return NULL;
+}
+
+
+// Segment n (1 to 35) of a 5x7 bitmap, S1 is the top left pixel
+static uint8_t Segment(const uint8_t* bitmap, int n) {
+    int row = (n - 1) / CHAR_WIDTH;
+    int col = (n - 1) % CHAR_WIDTH;
+    return (bitmap[row] >> (CHAR_WIDTH - 1 - col)) & 1;
+}
+
+
+// Pack a bitmap and annunciator into a packet, see the layout above Packets_to_chars()
+//
+// S17 S16 S15 S14 S13 S12 S11 S10
+// S9  S8  S7  S6  S5  S4  S3  S2
+// S1  S36 0   0   0   0   S35 S34
+// S33 S32 S31 S30 S29 S28 S27 S26
+// S25 S24 S23 S22 S21 S20 S19 S18
+static void PackCell(uint8_t* packet, const uint8_t* bitmap, int annunciator) {
+    memset(packet, 0, PACKET_WIDTH);
+
+    for (int n = 2; n <= 9; n++)   packet[1] |= Segment(bitmap, n) << (n - 2);
+    for (int n = 10; n <= 17; n++) packet[0] |= Segment(bitmap, n) << (n - 10);
+    for (int n = 18; n <= 25; n++) packet[4] |= Segment(bitmap, n) << (n - 18);
+    for (int n = 26; n <= 33; n++) packet[3] |= Segment(bitmap, n) << (n - 26);
+
+    packet[2] = (Segment(bitmap, 1) << 7) | (annunciator ? 0x40 : 0) | (Segment(bitmap, 35) << 1) | Segment(bitmap, 34);
+}
+
+
+// Copy a text field, expanding \xNN escapes and padding with spaces
+static void ParseText(char* out, int length, const char* in) {
+    int n = 0;
+
+    while (*in && n < length) {
+        if (in[0] == '\\' && in[1] == 'x' && in[2] && in[3]) {
+            char hex[3] = { in[2], in[3], 0 };
+            out[n++] = (char)strtol(hex, NULL, 16);
+            in += 4;
+        }
+        else {
+            out[n++] = *in++;
+        }
+    }
+    while (n < length) {
+        out[n++] = ' ';
+    }
+}
+
+
+// Build one frame, returns the number of characters missing from the font
+static int BuildFrame(uint8_t* frame, const char* text, const uint8_t* annunc) {
+    uint8_t cell_to_packet[CHAR_COUNT];
+    int missing = 0;
+
+    for (int i = 0; i < PACKET_COUNT; i++) {
+        cell_to_packet[Reorder[i]] = (uint8_t)i;
+    }
+
+    for (int cell = 0; cell < CHAR_COUNT; cell++) {
+        const uint8_t* bitmap = FindBitmap(text[cell]);
+        if (bitmap == NULL) {
+            fprintf(stderr, "G%d: no bitmap for 0x%02X, using space\n", cell + 1, (unsigned char)text[cell]);
+            bitmap = FindBitmap(' ');
+            missing++;
+        }
+
+        // Annunciator n sits on cell G(n), see ReorderAnnunciators()
+        int annunciator = cell < ANNUNC_COUNT ? annunc[cell] : 0;
+        PackCell(&frame[cell_to_packet[cell] * PACKET_WIDTH], bitmap, annunciator);
+    }
+
+    return missing;
+}
+
+
+// Decode the frame again and compare with what was asked for
+static int CheckFrame(const uint8_t* frame, const char* text, const uint8_t* annunc) {
+    Packets_to_chars(frame);
+
+    for (int cell = 0; cell < CHAR_COUNT; cell++) {
+        const uint8_t* bitmap = FindBitmap(text[cell]);
+        if (bitmap != NULL && memcmp(chars[cell], bitmap, CHAR_HEIGHT) != 0) {
+            fprintf(stderr, "G%d: packing does not round trip\n", cell + 1);
+            return 0;
+        }
+        if (cell < ANNUNC_COUNT && flags[cell] != annunc[cell]) {
+            fprintf(stderr, "G%d: annunciator does not round trip\n", cell + 1);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s screens.txt frames.bin\n", argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(argv[1], "r");
+    if (in == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    FILE* out = fopen(argv[2], "wb");
+    if (out == NULL) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    char line[512];
+    int line_number = 0;
+    long frames = 0;
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        line_number++;
+        line[strcspn(line, "\r\n")] = 0;
+        if (line[0] == 0 || line[0] == '#') {
+            continue;
+        }
+
+        // Split into fields
+        char* field[4] = { line, "", "", "1" };
+        char* p = line;
+        for (int f = 1; f < 4 && (p = strchr(p, '|')) != NULL; f++) {
+            *p++ = 0;
+            field[f] = p;
+        }
+
+        char text[CHAR_COUNT];
+        uint8_t annunc[ANNUNC_COUNT] = { 0 };
+        uint8_t frame[FRAME_SIZE];
+
+        ParseText(text, LINE1_LEN, field[0]);
+        ParseText(text + LINE1_LEN, LINE2_LEN, field[1]);
+        for (int a = 0; a < ANNUNC_COUNT && field[2][a]; a++) {
+            annunc[a] = field[2][a] == '1';
+        }
+        long scans = strtol(field[3], NULL, 10);
+
+        if (BuildFrame(frame, text, annunc) != 0) {
+            fprintf(stderr, "%s:%d: characters missing from font\n", argv[1], line_number);
+        }
+        if (!CheckFrame(frame, text, annunc)) {
+            fprintf(stderr, "%s:%d: internal error\n", argv[1], line_number);
+            return 1;
+        }
+
+        for (long s = 0; s < scans; s++) {
+            fwrite(frame, 1, FRAME_SIZE, out);
+            frames++;
+        }
+    }
+
+    fclose(in);
+    if (fclose(out) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    printf("%ld frames written to %s\n", frames, argv[2]);
+    return 0;
+}
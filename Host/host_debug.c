@@ -0,0 +1,31 @@
+/**
+  ******************************************************************************
+  * @file    host_debug.c
+  * @brief   PC stand-in for debug.c, debug channel output
+  *          goes to stdout
+  ******************************************************************************
+*/
+
+#include "debug.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+void Debug_Init(void) {}
+
+void Debug_Poll(void) {}
+
+uint8_t Debug_Pending(void) {
+    return 0;
+}
+
+void Debug_Write(const char* text) {
+    fputs(text, stdout);
+}
+
+void Debug_Printf(const char* format, ...) {
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
@@ -0,0 +1,181 @@
+/**
+  ******************************************************************************
+  * @file    rec_convert.c
+  * @brief   Convert a recorder stream into plain frames for
+  *          decode_bench (PC only)
+  ******************************************************************************
+*/
+
+// Usage: rec_convert recording.rec frames.bin
+//
+// Reads a stream saved from the debug channel while the recorder was running (format in
+// Core/Inc/recorder.h), rebuilds every frame and writes them as a plain sequence of 235 byte
+// frames. Text before the stream starts and damaged records are skipped. Prints a summary
+// of the recording: frame count, gaps in the sequence numbers and the scan period.
+
+#include "recorder.h"
+#include "capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static uint16_t Get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t Get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s recording.rec frames.bin\n", argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(argv[1], "rb");
+    if (in == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    uint8_t* data = malloc(size > 0 ? (size_t)size : 1);
+    if (data == NULL || fread(data, 1, (size_t)size, in) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", argv[1]);
+        return 1;
+    }
+    fclose(in);
+
+    FILE* out = fopen(argv[2], "wb");
+    if (out == NULL) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    uint8_t frame[CAPTURE_FRAME_SIZE];
+    int have_frame = 0;
+    uint32_t clock_hz = 72000000;
+    long frames = 0, keyframes = 0, deltas = 0, bad = 0, skipped = 0, gaps = 0, lost = 0, waiting = 0;
+    long stream_bytes = 0;
+    uint16_t last_sequence = 0;
+    int have_sequence = 0;
+    uint32_t last_timestamp = 0;
+    double period_min = 1e30, period_max = 0, period_sum = 0;
+    long periods = 0;
+
+    long pos = 0;
+    while (pos + RECORDER_HEADER_SIZE + 1 <= size) {
+        const uint8_t* r = &data[pos];
+        if (r[0] != RECORDER_SYNC) {
+            pos++;
+            skipped++;
+            continue;
+        }
+
+        uint16_t payload = Get16(&r[2]);
+        long length = RECORDER_HEADER_SIZE + payload + 1;
+        uint8_t checksum = 0;
+        if (payload > CAPTURE_FRAME_SIZE || pos + length > size) {
+            pos++;
+            skipped++;
+            continue;
+        }
+        for (long i = 0; i < length; i++) {
+            checksum ^= r[i];
+        }
+        if (checksum != 0) {
+            pos++;
+            bad++;
+            continue;
+        }
+
+        uint8_t type = r[1];
+        uint32_t timestamp = Get32(&r[4]);
+        uint16_t sequence = Get16(&r[8]);
+        const uint8_t* p = &r[RECORDER_HEADER_SIZE];
+        pos += length;
+        stream_bytes += length;
+
+        if (type == RECORDER_START) {
+            if (payload >= 6 && p[1] != CAPTURE_FRAME_SIZE) {
+                fprintf(stderr, "recording has %u byte frames, expected %d\n", p[1], CAPTURE_FRAME_SIZE);
+                return 1;
+            }
+            if (payload >= 6) {
+                clock_hz = Get32(&p[2]);
+            }
+            have_frame = 0;
+            have_sequence = 0;
+            continue;
+        }
+        if (type == RECORDER_STOP) {
+            continue;
+        }
+
+        // Sequence gaps are frames the recorder could not queue
+        if (have_sequence && sequence != (uint16_t)(last_sequence + 1)) {
+            gaps++;
+            lost += (uint16_t)(sequence - last_sequence - 1);
+            have_frame = 0;
+        }
+        else if (have_sequence) {
+            double period = (double)(uint32_t)(timestamp - last_timestamp) * 1e6 / clock_hz;
+            if (period < period_min) period_min = period;
+            if (period > period_max) period_max = period;
+            period_sum += period;
+            periods++;
+        }
+        have_sequence = 1;
+        last_sequence = sequence;
+        last_timestamp = timestamp;
+
+        if (type == RECORDER_KEYFRAME && payload == CAPTURE_FRAME_SIZE) {
+            memcpy(frame, p, CAPTURE_FRAME_SIZE);
+            have_frame = 1;
+            keyframes++;
+        }
+        else if (type == RECORDER_DELTA && have_frame) {
+            uint16_t i = 0;
+            while (i + 2 <= payload) {
+                uint8_t start = p[i], count = p[i + 1];
+                if (start + count > CAPTURE_FRAME_SIZE || i + 2 + count > payload) {
+                    have_frame = 0;
+                    bad++;
+                    break;
+                }
+                memcpy(&frame[start], &p[i + 2], count);
+                i += 2 + count;
+            }
+            deltas++;
+        }
+        else {
+            waiting++;      // Delta before the first keyframe, cannot be rebuilt
+            continue;
+        }
+
+        if (have_frame) {
+            fwrite(frame, 1, CAPTURE_FRAME_SIZE, out);
+            frames++;
+        }
+    }
+
+    if (fclose(out) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    printf("%ld frames written to %s (%ld keyframes, %ld deltas)\n", frames, argv[2], keyframes, deltas);
+    printf("%ld bytes of stream, %.1f bytes/frame\n", stream_bytes, frames ? (double)stream_bytes / frames : 0.0);
+    printf("%ld gaps, %ld frames lost, %ld damaged records, %ld bytes skipped, %ld deltas before first keyframe\n",
+        gaps, lost, bad, skipped, waiting);
+    if (periods != 0) {
+        printf("scan period min %.0f us, avg %.0f us, max %.0f us\n", period_min, period_sum / periods, period_max);
+    }
+
+    free(data);
+    return 0;
+}
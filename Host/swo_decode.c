@@ -0,0 +1,236 @@
+/**
+  ******************************************************************************
+  * @file    swo_decode.c
+  * @brief   Turn a captured SWO stream of pipeline events into
+  *          a timeline and summary statistics (PC only)
+  ******************************************************************************
+*/
+
+// Usage: swo_decode [-t] [-c clock_hz] trace.swo
+//
+// Reads the raw SWO byte stream saved by the debug probe (e.g. the ST-LINK SWV capture to file,
+// or openocd "tpiu config ... uart off <clock> 2000000" with the output sent to a file) and picks
+// out the pipeline events written by Core/Src/trace.c (format in Core/Inc/trace.h). ITM sync,
+// overflow, timestamp and hardware source packets are skipped. -t prints every event with its
+// time, otherwise only the summary: event counts, frame rate, decode and render times, LT7680 bus
+// bytes per render pass and timeouts. -c gives the core clock if it is not 72 MHz.
+
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static const char* const event_names[TRACE_EVENTS] = {
+    "?", "FRAME", "DECODE", "RENDER_START", "RENDER_END", "BUS", "TIMEOUT"
+};
+
+typedef struct {
+    long count;
+    double min;
+    double max;
+    double sum;
+} Stat;
+
+
+static void StatAdd(Stat* s, double value) {
+    if (s->count == 0 || value < s->min) {
+        s->min = value;
+    }
+    if (s->count == 0 || value > s->max) {
+        s->max = value;
+    }
+    s->sum += value;
+    s->count++;
+}
+
+
+static void StatPrint(const char* name, const Stat* s, const char* unit) {
+    if (s->count == 0) {
+        printf("%-16s -\n", name);
+        return;
+    }
+    printf("%-16s min %9.1f  avg %9.1f  max %9.1f %s  (%ld)\n",
+        name, s->min, s->sum / s->count, s->max, unit, s->count);
+}
+
+
+int main(int argc, char** argv) {
+    int timeline = 0;
+    double clock_hz = 72000000.0;
+    const char* path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0) {
+            timeline = 1;
+        }
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            clock_hz = atof(argv[++i]);
+        }
+        else if (path == NULL && argv[i][0] != '-') {
+            path = argv[i];
+        }
+        else {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL || clock_hz <= 0) {
+        fprintf(stderr, "usage: %s [-t] [-c clock_hz] trace.swo\n", argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(path, "rb");
+    if (in == NULL) {
+        perror(path);
+        return 1;
+    }
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    uint8_t* data = malloc(size > 0 ? (size_t)size : 1);
+    if (data == NULL || fread(data, 1, (size_t)size, in) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", path);
+        return 1;
+    }
+    fclose(in);
+
+    const double tick_us = (double)(1UL << TRACE_TIME_SHIFT) * 1e6 / clock_hz;
+    const uint32_t time_mask = (1UL << TRACE_TIME_BITS) - 1;
+
+    long events[TRACE_EVENTS] = { 0 };
+    long overflows = 0, other = 0, truncated = 0;
+    long timeouts_status = 0, timeouts_register = 0;
+    int64_t now = 0;                    // Unwrapped time in ticks
+    uint32_t last_raw = 0;
+    int have_time = 0;
+    int64_t first_frame = 0, last_frame = 0, render_start = 0;
+    int have_render_start = 0;
+    Stat frame_period = { 0 }, decode = { 0 }, render = { 0 }, bus = { 0 };
+
+    long pos = 0;
+    while (pos < size) {
+        uint8_t header = data[pos];
+
+        // Sync (a run of zeros ended by 0x80) and overflow
+        if (header == 0x00 || header == 0x80) {
+            pos++;
+            continue;
+        }
+        if (header == 0x70) {
+            overflows++;
+            pos++;
+            continue;
+        }
+
+        // Protocol packets (timestamps, extension): header, then continuation bytes while bit 7 is set
+        if ((header & 0x03) == 0) {
+            pos++;
+            if (header & 0x80) {
+                while (pos < size && (data[pos] & 0x80)) {
+                    pos++;
+                }
+                pos++;
+            }
+            continue;
+        }
+
+        // Source packets: 1, 2 or 4 byte payload
+        long payload = (header & 0x03) == 3 ? 4 : (header & 0x03);
+        if (pos + 1 + payload > size) {
+            truncated++;
+            break;
+        }
+        const uint8_t* p = &data[pos + 1];
+        pos += 1 + payload;
+
+        uint8_t port = header >> 3;
+        if ((header & 0x04) || payload != 4 || port == 0 || port >= TRACE_EVENTS) {
+            other++;                    // DWT hardware packets, printf on port 0, anything else
+            continue;
+        }
+
+        uint32_t word = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        uint32_t raw = word & time_mask;
+        uint32_t arg = word >> TRACE_TIME_BITS;
+
+        // Events come far more often than the 0.93 s wrap. A step of more than half the range is an event
+        // that took its time, was preempted by an ISR event and went out after it, so it steps back.
+        if (have_time) {
+            uint32_t step = (raw - last_raw) & time_mask;
+            now += step <= time_mask / 2 ? (int64_t)step : (int64_t)step - (int64_t)time_mask - 1;
+        }
+        last_raw = raw;
+        have_time = 1;
+        events[port]++;
+
+        switch (port) {
+        case TRACE_FRAME:
+            if (events[port] > 1) {
+                StatAdd(&frame_period, (now - last_frame) * tick_us);
+            }
+            else {
+                first_frame = now;
+            }
+            last_frame = now;
+            break;
+        case TRACE_DECODE:
+            StatAdd(&decode, arg);
+            break;
+        case TRACE_RENDER_START:
+            render_start = now;
+            have_render_start = 1;
+            break;
+        case TRACE_RENDER_END:
+            if (have_render_start) {
+                StatAdd(&render, (now - render_start) * tick_us);
+                have_render_start = 0;
+            }
+            break;
+        case TRACE_BUS:
+            StatAdd(&bus, (double)(arg << TRACE_BUS_SHIFT));
+            break;
+        case TRACE_TIMEOUT:
+            if (arg == 0x100) {
+                timeouts_status++;
+            }
+            else {
+                timeouts_register++;
+            }
+            break;
+        }
+
+        if (timeline) {
+            printf("%14.1f us  %-12s %u", now * tick_us, event_names[port],
+                (unsigned)(port == TRACE_BUS ? arg << TRACE_BUS_SHIFT : arg));
+            if (port == TRACE_TIMEOUT) {
+                if (arg == 0x100) {
+                    printf("  (status)");
+                }
+                else {
+                    printf("  (REG %02X)", (unsigned)arg);
+                }
+            }
+            printf("\n");
+        }
+    }
+
+    free(data);
+
+    printf("Events:          ");
+    for (int i = 1; i < TRACE_EVENTS; i++) {
+        printf(" %s %ld", event_names[i], events[i]);
+    }
+    printf("\n");
+    printf("Span:             %.3f s, %ld overflow packets, %ld other packets%s\n",
+        now * tick_us / 1e6, overflows, other, truncated ? ", stream truncated" : "");
+    if (events[TRACE_FRAME] > 1) {
+        printf("Frame rate:       %.1f Hz\n", (events[TRACE_FRAME] - 1) * 1e6 / ((last_frame - first_frame) * tick_us));
+    }
+    StatPrint("Frame period:", &frame_period, "us");
+    StatPrint("Decode:", &decode, "us");
+    StatPrint("Render:", &render, "us");
+    StatPrint("Bus per render:", &bus, "bytes");
+    printf("Timeouts:         %ld status, %ld register\n", timeouts_status, timeouts_register);
+    return 0;
+}
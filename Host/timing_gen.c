@@ -0,0 +1,154 @@
+/**
+  ******************************************************************************
+  * @file    timing_gen.c
+  * @brief   Build the user timing profile page from text for
+  *          programming into Flash (PC only)
+  ******************************************************************************
+*/
+
+// Usage: timing_gen profiles.txt profiles.hex|profiles.bin
+//
+// Each line of the text file describes one timing set, in the column order of the built-in table
+// in Core/Src/timings.c:
+//
+//   VBPD VFPD VSPW HBPD HFPD HSPW REFRESH PANEL
+//
+//   porches and sync widths in lines (vertical) and pixels (horizontal), REFRESH in Hz,
+//   PANEL the ST7701S init table, AdaF or BuyD
+//
+// Lines that are empty or start with # are ignored.
+//
+// Every line becomes a packed TimingProfile record (Core/Inc/timings.h) with its LT7680 PLL
+// registers worked out by the same macros the built-in table uses, and is checked with the same
+// limits the firmware applies at boot. The output is the whole TIMINGS_USER_SIZE page, records
+// first and the rest left erased (0xFF): a .bin to program at TIMINGS_USER_ADDRESS, or an Intel
+// HEX file that carries the address itself. Profiles follow the built-in ones on the timing
+// adjust screen.
+
+#define TIMINGS_HOST
+#include "timings.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEX_LINE_BYTES  16
+
+
+static void HexRecord(FILE* out, uint8_t type, uint16_t address, const uint8_t* data, uint8_t length) {
+    uint8_t sum = (uint8_t)(length + (address >> 8) + (address & 0xFF) + type);
+
+    fprintf(out, ":%02X%04X%02X", length, address, type);
+    for (uint8_t i = 0; i < length; i++) {
+        fprintf(out, "%02X", data[i]);
+        sum += data[i];
+    }
+    fprintf(out, "%02X\n", (uint8_t)-sum);
+}
+
+
+static int WriteHex(FILE* out, const uint8_t* page, uint32_t size) {
+    const uint8_t upper[2] = { (uint8_t)(TIMINGS_USER_ADDRESS >> 24), (uint8_t)(TIMINGS_USER_ADDRESS >> 16) };
+
+    HexRecord(out, 0x04, 0, upper, 2);                      // Extended linear address
+    for (uint32_t offset = 0; offset < size; offset += HEX_LINE_BYTES) {
+        HexRecord(out, 0x00, (uint16_t)((TIMINGS_USER_ADDRESS + offset) & 0xFFFF), &page[offset], HEX_LINE_BYTES);
+    }
+    HexRecord(out, 0x01, 0, NULL, 0);                       // End of file
+    return 0;
+}
+
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s profiles.txt profiles.hex|profiles.bin\n", argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(argv[1], "r");
+    if (in == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    static uint8_t page[TIMINGS_USER_SIZE];
+    const int max = TIMINGS_USER_SIZE / sizeof(TimingProfile);
+    int count = 0, line_number = 0, errors = 0;
+    char line[256];
+
+    memset(page, 0xFF, sizeof(page));
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        line_number++;
+        char* p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue;
+        }
+
+        unsigned vbpd, vfpd, vspw, hbpd, hfpd, hspw, rate;
+        char panel[16];
+        if (sscanf(p, "%u %u %u %u %u %u %u %15s", &vbpd, &vfpd, &vspw, &hbpd, &hfpd, &hspw, &rate, panel) != 8) {
+            fprintf(stderr, "%s:%d: expected VBPD VFPD VSPW HBPD HFPD HSPW REFRESH PANEL\n", argv[1], line_number);
+            errors++;
+            continue;
+        }
+        if (strcmp(panel, "AdaF") != 0 && strcmp(panel, "BuyD") != 0) {
+            fprintf(stderr, "%s:%d: panel must be AdaF or BuyD\n", argv[1], line_number);
+            errors++;
+            continue;
+        }
+        if (vbpd > 0xFF || vfpd > 0xFF || vspw > 0xFF || hbpd > 0xFFFF || hfpd > 0xFFFF || hspw > 0xFFFF || rate > 0xFF) {
+            fprintf(stderr, "%s:%d: value out of range\n", argv[1], line_number);
+            errors++;
+            continue;
+        }
+        if (count == max) {
+            fprintf(stderr, "%s:%d: page full, at most %d profiles\n", argv[1], line_number, max);
+            errors++;
+            break;
+        }
+
+        TimingProfile profile = {
+            .magic = TIMINGS_MAGIC,
+            .vbpd = (uint8_t)vbpd, .vfpd = (uint8_t)vfpd, .vspw = (uint8_t)vspw,
+            .hbpd = (uint16_t)hbpd, .hfpd = (uint16_t)hfpd, .hspw = (uint16_t)hspw,
+            .refresh_rate = (uint8_t)rate,
+            .reserved = 0xFF,
+        };
+        const uint8_t pll[6] = TIMINGS_PLL(TIMINGS_MHZ(vbpd, vfpd, vspw, hbpd, hfpd, hspw, rate));
+        memcpy(profile.pll, pll, sizeof(pll));
+        strcpy(profile.panel, panel);
+
+        if (!Timings_Valid(&profile)) {
+            fprintf(stderr, "%s:%d: outside the limits the firmware accepts, see Timings_Valid()\n", argv[1], line_number);
+            errors++;
+            continue;
+        }
+
+        // The Flash is little endian, and so is every PC this runs on
+        memcpy(&page[count * sizeof(TimingProfile)], &profile, sizeof(profile));
+        count++;
+    }
+    fclose(in);
+
+    if (errors != 0) {
+        return 1;
+    }
+
+    FILE* out = fopen(argv[2], "wb");
+    if (out == NULL) {
+        perror(argv[2]);
+        return 1;
+    }
+    size_t length = strlen(argv[2]);
+    if (length > 4 && strcmp(&argv[2][length - 4], ".hex") == 0) {
+        WriteHex(out, page, sizeof(page));
+    }
+    else {
+        fwrite(page, 1, sizeof(page), out);
+    }
+    fclose(out);
+
+    printf("%d profiles, %u of %u bytes, for 0x%08X\n", count, (unsigned)(count * sizeof(TimingProfile)),
+        (unsigned)sizeof(page), (unsigned)TIMINGS_USER_ADDRESS);
+    return 0;
+}